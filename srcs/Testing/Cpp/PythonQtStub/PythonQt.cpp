@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// PythonQtStub includes
+#include "PythonQt.h"
+
+//-----------------------------------------------------------------------------
+PythonQt::PythonQt()
+{
+  this->RegisterClassCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+PythonQt* PythonQt::self()
+{
+  static PythonQt instance;
+  return &instance;
+}
+
+//-----------------------------------------------------------------------------
+void PythonQt::registerClass(const QMetaObject* metaObject, const char* package,
+                             PythonQtQObjectCreatorFunctionCB* wrapperCreator)
+{
+  Q_UNUSED(package);
+  this->RegisterClassCount++;
+  this->WrapperCreators.insert(metaObject->className(), wrapperCreator);
+}
+
+//-----------------------------------------------------------------------------
+int PythonQt::registerClassCount()const
+{
+  return this->RegisterClassCount;
+}
+
+//-----------------------------------------------------------------------------
+PythonQtQObjectCreatorFunctionCB* PythonQt::wrapperCreator(const QByteArray& className)const
+{
+  return this->WrapperCreators.value(className, 0);
+}
+
+//-----------------------------------------------------------------------------
+void PythonQt::addPolymorphicHandler(const char* typeName, PythonQtPolymorphicHandlerCB* cb)
+{
+  this->PolymorphicHandlers.insert(typeName, cb);
+}
+
+//-----------------------------------------------------------------------------
+void* PythonQt::castDownIfPossible(const char* typeName, void* ptr,
+                                   const char** className)const
+{
+  *className = typeName;
+  foreach(PythonQtPolymorphicHandlerCB* cb, this->PolymorphicHandlers.values(typeName))
+    {
+    const char* derivedClassName = 0;
+    void* derivedPtr = cb(ptr, &derivedClassName);
+    if (derivedPtr)
+      {
+      *className = derivedClassName;
+      return derivedPtr;
+      }
+    }
+  return ptr;
+}
+
+//-----------------------------------------------------------------------------
+void PythonQt::clear()
+{
+  this->RegisterClassCount = 0;
+  this->WrapperCreators.clear();
+  this->PolymorphicHandlers.clear();
+}
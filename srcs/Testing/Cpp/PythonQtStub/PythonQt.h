@@ -0,0 +1,91 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __PythonQt_h
+#define __PythonQt_h
+
+// Qt includes
+#include <QByteArray>
+#include <QHash>
+#include <QMetaObject>
+#include <QObject>
+
+/**
+ * Stand-in for the subset of PythonQt used by the generated _init.cpp
+ * files, so that they can be compiled, linked and timed without Python.
+ *
+ * registerClass() only records its arguments; no Python type is created.
+ * The polymorphic handlers are applied by castDownIfPossible(), as PythonQt
+ * does when a wrapped function returns a pointer.
+ */
+
+#if defined(_WIN32) && defined(PythonQtStub_EXPORTS)
+# define PYTHONQT_EXPORT __declspec(dllexport)
+#elif defined(_WIN32)
+# define PYTHONQT_EXPORT __declspec(dllimport)
+#else
+# define PYTHONQT_EXPORT
+#endif
+
+typedef struct _object PyObject;
+
+// Same signatures as PythonQt, the generated code depends on them
+typedef void* PythonQtQObjectCreatorFunctionCB();
+
+typedef void* PythonQtPolymorphicHandlerCB(const void* ptr, const char** className);
+
+template<class T> void* PythonQtCreateObject()
+{
+  return new T();
+}
+
+class PYTHONQT_EXPORT PythonQt
+{
+public:
+  static PythonQt* self();
+
+  void registerClass(const QMetaObject* metaObject, const char* package = 0,
+                     PythonQtQObjectCreatorFunctionCB* wrapperCreator = 0);
+
+  /// Number of calls to registerClass().
+  int registerClassCount()const;
+
+  /// Wrapper creator registered for \a className, or 0.
+  PythonQtQObjectCreatorFunctionCB* wrapperCreator(const QByteArray& className)const;
+
+  void addPolymorphicHandler(const char* typeName, PythonQtPolymorphicHandlerCB* cb);
+
+  /// Apply the handlers registered for \a typeName to \a ptr, and return
+  /// the downcasted pointer and its class name, or \a ptr and \a typeName
+  /// if no handler recognized it.
+  void* castDownIfPossible(const char* typeName, void* ptr, const char** className)const;
+
+  /// Forget the registered classes and handlers.
+  void clear();
+
+private:
+  PythonQt();
+
+  int RegisterClassCount;
+  QHash<QByteArray, PythonQtQObjectCreatorFunctionCB*> WrapperCreators;
+  QMultiHash<QByteArray, PythonQtPolymorphicHandlerCB*> PolymorphicHandlers;
+};
+
+#endif
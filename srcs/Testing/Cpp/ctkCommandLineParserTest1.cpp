@@ -0,0 +1,93 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkCommandLineParser.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+//-----------------------------------------------------------------------------
+int ctkCommandLineParserTest1(int argc, char* argv[])
+{
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+
+  ctkCommandLineParser parser;
+  parser.setArgumentPrefix("--", "-");
+  ctkCommandLineArgument<bool> help = parser.addArgument<bool>("help", "h", "Help.");
+  ctkCommandLineArgument<bool> verbose = parser.addArgument<bool>("verbose", "v", "Verbose.");
+  ctkCommandLineArgument<int> jobs = parser.addArgument<int>("jobs", "j", "Jobs.", 1);
+  ctkCommandLineArgument<QString> output = parser.addArgument<QString>("output-dir", "o", "Output.");
+  ctkCommandLineArgument<QString> name =
+      parser.addArgument<QString>("name", "", "Name.", QString("default"));
+  ctkCommandLineArgument<QStringList> paths = parser.addArgument<QStringList>("paths", "", "Paths.");
+  ctkCommandLineArgument<int> duplicate = parser.addArgument<int>("jobs", "", "Duplicate.");
+
+  ctkPythonQtWrapperCheckMacro(help.isValid());
+  ctkPythonQtWrapperCheckMacro(jobs.isValid());
+  ctkPythonQtWrapperCheckMacro(paths.isValid());
+  // The name is already used
+  ctkPythonQtWrapperCheckMacro(!duplicate.isValid());
+
+  QStringList arguments;
+  arguments << "PythonQtWrapper" << "-v" << "--jobs" << "4" << "-o" << "/tmp/out"
+            << "ctkFoo.h" << "--paths" << "a" << "b";
+  bool ok = false;
+  parser.parseArguments(arguments, &ok);
+  ctkPythonQtWrapperCheckMacro(ok);
+
+  ctkPythonQtWrapperCheckMacro(!parser.value(help));
+  ctkPythonQtWrapperCheckMacro(!parser.isSet(help));
+  ctkPythonQtWrapperCheckMacro(parser.value(verbose));
+  ctkPythonQtWrapperCheckMacro(parser.isSet(verbose));
+  ctkPythonQtWrapperCheckMacro(parser.value(jobs) == 4);
+  ctkPythonQtWrapperCheckMacro(parser.value(output) == "/tmp/out");
+  // Defaulted
+  ctkPythonQtWrapperCheckMacro(parser.value(name) == "default");
+  ctkPythonQtWrapperCheckMacro(parser.isSet(name));
+  ctkPythonQtWrapperCheckMacro(parser.value(paths) == (QStringList() << "a" << "b"));
+
+  // Invalid handles read the default constructed value
+  ctkPythonQtWrapperCheckMacro(parser.value(duplicate) == 0);
+  ctkPythonQtWrapperCheckMacro(!parser.isSet(duplicate));
+  ctkCommandLineArgument<QString> unset;
+  ctkPythonQtWrapperCheckMacro(parser.value(unset).isEmpty());
+
+  // Values of a second parse don't leak from the first one
+  arguments.clear();
+  arguments << "PythonQtWrapper" << "ctkFoo.h";
+  parser.parseArguments(arguments, &ok);
+  ctkPythonQtWrapperCheckMacro(ok);
+  ctkPythonQtWrapperCheckMacro(!parser.value(verbose));
+  ctkPythonQtWrapperCheckMacro(parser.value(jobs) == 1);
+  ctkPythonQtWrapperCheckMacro(parser.value(output).isEmpty());
+  ctkPythonQtWrapperCheckMacro(parser.value(paths).isEmpty());
+  ctkPythonQtWrapperCheckMacro(parser.unparsedArguments() == QStringList("ctkFoo.h"));
+
+  // Invalid value
+  arguments.clear();
+  arguments << "PythonQtWrapper" << "--jobs" << "many";
+  parser.parseArguments(arguments, &ok);
+  ctkPythonQtWrapperCheckMacro(!ok);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperAnalysisCache.h"
+#include "ctkPythonQtWrapperClangAnalyzer.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Analyse \a header with \a wrapper and return the number of analyses found
+// in \a cache.
+int cacheHits(ctkPythonQtWrapper& wrapper, ctkPythonQtWrapperAnalysisCache& cache,
+              const QString& header)
+{
+  cache.resetStatistics();
+  wrapper.setRejectionMessagesEnabled(false);
+  wrapper.setAnalysisCache(&cache);
+  wrapper.setInput(QStringList() << header);
+  wrapper.validateInputFiles();
+  return cache.hitCount();
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperAnalysisCacheTest1(int argc, char* argv[])
+{
+  if (argc < 3)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperAnalysisCacheTest1 <data-directory> "
+                 "<temporary-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir data(argv[1]);
+  QDir temporary(argv[2]);
+  ctkPythonQtWrapperCheckMacro(temporary.mkpath("."));
+  // The header is modified below
+  QString header = temporary.filePath("ctkFixtureObject.h");
+  QFile::remove(header);
+  ctkPythonQtWrapperCheckMacro(QFile::copy(data.filePath("ctkFixtureObject.h"), header));
+
+  ctkPythonQtWrapperAnalysisCache cache;
+  ctkPythonQtWrapper first;
+  ctkPythonQtWrapperCheckMacro(cacheHits(first, cache, header) == 0);
+  ctkPythonQtWrapperCheckMacro(cache.missCount() == 1);
+  ctkPythonQtWrapperCheckMacro(cache.count() == 1);
+  ctkPythonQtWrapperCheckMacro(first.analyses().at(0).Valid);
+
+  // Same file and same options
+  ctkPythonQtWrapper unchanged;
+  ctkPythonQtWrapperCheckMacro(cacheHits(unchanged, cache, header) == 1);
+  ctkPythonQtWrapperCheckMacro(unchanged.analyses().at(0) == first.analyses().at(0));
+
+  // The analysis options changed
+  ctkPythonQtWrapper decorators;
+  decorators.setDecoratorsEnabled(true);
+  ctkPythonQtWrapperCheckMacro(cacheHits(decorators, cache, header) == 0);
+  ctkPythonQtWrapper decoratorsUnchanged;
+  decoratorsUnchanged.setDecoratorsEnabled(true);
+  ctkPythonQtWrapperCheckMacro(cacheHits(decoratorsUnchanged, cache, header) == 1);
+
+  // The stamp of the file changed
+  QFile file(header);
+  ctkPythonQtWrapperCheckMacro(file.open(QIODevice::WriteOnly | QIODevice::Append));
+  ctkPythonQtWrapperCheckMacro(file.write("// Modified\n") > 0);
+  file.close();
+  ctkPythonQtWrapper modified;
+  modified.setDecoratorsEnabled(true);
+  ctkPythonQtWrapperCheckMacro(cacheHits(modified, cache, header) == 0);
+  ctkPythonQtWrapperCheckMacro(modified.analyses().at(0).Valid);
+  ctkPythonQtWrapperCheckMacro(cache.count() == 1);
+
+  // The libclang backend and its arguments, when built with it
+  ctkPythonQtWrapper clang;
+  clang.setDecoratorsEnabled(true);
+  if (clang.setClangBackendEnabled(true))
+    {
+    ctkPythonQtWrapperCheckMacro(cacheHits(clang, cache, header) == 0);
+    ctkPythonQtWrapper clangArguments;
+    clangArguments.setDecoratorsEnabled(true);
+    ctkPythonQtWrapperCheckMacro(clangArguments.setClangBackendEnabled(true));
+    clangArguments.clangAnalyzer().setArguments(QStringList() << "-DCTK_FIXTURE");
+    ctkPythonQtWrapperCheckMacro(cacheHits(clangArguments, cache, header) == 0);
+    ctkPythonQtWrapper clangUnchanged;
+    clangUnchanged.setDecoratorsEnabled(true);
+    ctkPythonQtWrapperCheckMacro(clangUnchanged.setClangBackendEnabled(true));
+    clangUnchanged.clangAnalyzer().setArguments(QStringList() << "-DCTK_FIXTURE");
+    ctkPythonQtWrapperCheckMacro(cacheHits(clangUnchanged, cache, header) == 1);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QThread>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// In-memory header of the given kind: valid with a parent, valid without
+// parent, abstract or without Q_OBJECT.
+QByteArray corpusHeader(const QString& className, int kind)
+{
+  QByteArray name = className.toLatin1();
+  QByteArray body;
+  switch (kind)
+    {
+    case 0:
+      body = "  Q_OBJECT\n"
+             "  Q_PROPERTY(int value READ value WRITE setValue)\n"
+             "public:\n"
+             "  " + name + "(QObject* parent = 0) : QObject(parent) {}\n"
+             "  int value()const;\n"
+             "  void setValue(int value);\n"
+             "  Q_INVOKABLE int add(int a, int b)const;\n";
+      break;
+    case 1:
+      body = "  Q_OBJECT\n"
+             "public:\n"
+             "  " + name + "() {}\n"
+             "  explicit " + name + "(QObject* parent) : QObject(parent) {}\n";
+      break;
+    case 2:
+      body = "  Q_OBJECT\n"
+             "public:\n"
+             "  " + name + "(QObject* parent = 0) : QObject(parent) {}\n"
+             "  virtual void run() = 0;\n";
+      break;
+    default:
+      body = "public:\n"
+             "  " + name + "(QObject* parent = 0) : QObject(parent) {}\n";
+      break;
+    }
+  return "#include <QObject>\n"
+         "\n"
+         "class " + name + " : public QObject\n"
+         "{\n" + body + "};\n";
+}
+
+//-----------------------------------------------------------------------------
+// Analyse every header, starting from a different one in every thread so
+// that the threads don't analyse the same header at the same time.
+class AnalysisThread : public QThread
+{
+public:
+  AnalysisThread(const ctkPythonQtWrapper& wrapper, int start)
+    : Wrapper(wrapper), Start(start) {}
+
+  virtual void run()
+  {
+    const QStringList& files = this->Wrapper.inputFiles();
+    for (int i = 0; i < files.count(); ++i)
+      {
+      int index = (this->Start + i) % files.count();
+      this->Analyses[index] = this->Wrapper.analyze(files.at(index));
+      }
+  }
+
+  const ctkPythonQtWrapper& Wrapper;
+  int Start;
+  QMap<int, ctkPythonQtWrapperAnalysis> Analyses;
+};
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperAnalysisTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperAnalysisTest1 <data-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir data(argv[1]);
+
+  ctkPythonQtWrapper wrapper;
+  wrapper.setWrappingNamespace("org.commontk.test");
+  wrapper.setTargetName("ctkFixtures");
+  wrapper.setRejectionMessagesEnabled(false);
+  wrapper.setDecoratorsEnabled(true);
+  ctkPythonQtWrapperCheckMacro(wrapper.setInput(QStringList()
+                                                << data.filePath("ctkFixtureAbstract.h")
+                                                << data.filePath("ctkFixtureDerivedObject.h")
+                                                << data.filePath("ctkFixtureNoParent.h")
+                                                << data.filePath("ctkFixtureNoQObject.h")
+                                                << data.filePath("ctkFixtureObject.h")
+                                                << data.filePath("ctkFixtureWidget.h")));
+  for (int index = 0; index < 200; ++index)
+    {
+    QString className = QString("ctkCorpusClass%1").arg(index);
+    wrapper.addInput(className + ".h", corpusHeader(className, index % 4));
+    }
+  const QStringList& files = wrapper.inputFiles();
+  ctkPythonQtWrapperCheckMacro(files.count() == 206);
+
+  QList<ctkPythonQtWrapperAnalysis> serialAnalyses;
+  int rejectedCount = 0;
+  for (int i = 0; i < files.count(); ++i)
+    {
+    serialAnalyses << wrapper.analyze(files.at(i));
+    rejectedCount += serialAnalyses.last().Valid ? 0 : 1;
+    }
+  ctkPythonQtWrapperCheckMacro(rejectedCount == 2 + 100);
+
+  // validate() is the verdict of analyze()
+  ctkPythonQtWrapperCheckMacro(wrapper.validate(files.at(1)));
+  ctkPythonQtWrapperCheckMacro(!wrapper.validate(files.at(0)));
+  ctkPythonQtWrapperCheckMacro(wrapper.lastError() == serialAnalyses.at(0).ErrorString);
+
+  // Concurrent calls of analyze() on the same wrapper
+  const int threadCount = 8;
+  QList<AnalysisThread*> threads;
+  for (int t = 0; t < threadCount; ++t)
+    {
+    threads << new AnalysisThread(wrapper, t * files.count() / threadCount);
+    }
+  for (int t = 0; t < threadCount; ++t)
+    {
+    threads.at(t)->start();
+    }
+  bool identical = true;
+  for (int t = 0; t < threadCount; ++t)
+    {
+    threads.at(t)->wait();
+    for (int i = 0; i < files.count(); ++i)
+      {
+      if (threads.at(t)->Analyses.value(i) != serialAnalyses.at(i))
+        {
+        std::cerr << "Thread " << t << " analysed " << qPrintable(files.at(i))
+                  << " differently" << std::endl;
+        identical = false;
+        }
+      }
+    delete threads.at(t);
+    }
+  ctkPythonQtWrapperCheckMacro(identical);
+
+  // The pipeline of validateInputFiles(), serial then with analyser threads
+  for (int round = 0; round < 3; ++round)
+    {
+    wrapper.setMaximumThreadCount(round == 0 ? 1 : threadCount);
+    ctkPythonQtWrapperCheckMacro(wrapper.validateInputFiles() == rejectedCount);
+    ctkPythonQtWrapperCheckMacro(wrapper.analyses() == serialAnalyses);
+    }
+
+  return EXIT_SUCCESS;
+}
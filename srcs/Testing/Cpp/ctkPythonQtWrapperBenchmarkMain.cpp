@@ -0,0 +1,75 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver timing the PythonQt_init_<ns>_<target>() function generated for a
+// synthetic corpus, linked against the PythonQt stub.
+//
+// PythonQtWrapper_BENCHMARK_INIT, PythonQtWrapper_BENCHMARK_TARGET and
+// PythonQtWrapper_BENCHMARK_CLASS_COUNT are defined by the build.
+
+// Qt includes
+#include <QCoreApplication>
+#include <QTime>
+
+// PythonQtStub includes
+#include "PythonQt.h"
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+
+void PythonQtWrapper_BENCHMARK_INIT(PyObject* module);
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  int repetitions = argc > 1 ? atoi(argv[1]) : 100;
+  if (repetitions <= 0)
+    {
+    fprintf(stderr, "error: Invalid repetition count [%s]\n", argv[1]);
+    return EXIT_FAILURE;
+    }
+
+  // The first call pays for the static initialization of the meta objects
+  PythonQtWrapper_BENCHMARK_INIT(0);
+  if (PythonQt::self()->registerClassCount() != PythonQtWrapper_BENCHMARK_CLASS_COUNT)
+    {
+    fprintf(stderr, "error: %d classes registered, %d expected\n",
+            PythonQt::self()->registerClassCount(), PythonQtWrapper_BENCHMARK_CLASS_COUNT);
+    return EXIT_FAILURE;
+    }
+
+  QTime time;
+  time.start();
+  for (int i = 0; i < repetitions; ++i)
+    {
+    PythonQt::self()->clear();
+    PythonQtWrapper_BENCHMARK_INIT(0);
+    }
+  int elapsed = time.elapsed();
+
+  // target, class count, repetitions, total ms, microseconds per call
+  printf("init\t%s\t%d\t%d\t%d\t%.3f\n", PythonQtWrapper_BENCHMARK_TARGET,
+         PythonQtWrapper_BENCHMARK_CLASS_COUNT, repetitions, elapsed,
+         1000.0 * elapsed / repetitions);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,25 @@
+#
+# Print the results logged by the benchmark drivers (file loader, memory
+# statistics and server), then the compile and link times, and the sizes of the files
+# they produced, logged by ctkPythonQtWrapperCompileLauncher.
+#
+# Usage: cmake -DLOG_FILE=<compile.log> [-DRESULTS_FILE=<results.log>]
+#          -P ctkPythonQtWrapperBenchmarkReport.cmake
+#
+
+IF(RESULTS_FILE AND EXISTS "${RESULTS_FILE}")
+  FILE(STRINGS "${RESULTS_FILE}" lines)
+  FOREACH(line ${lines})
+    MESSAGE("${line}")
+  ENDFOREACH()
+ENDIF()
+
+IF(NOT EXISTS "${LOG_FILE}")
+  MESSAGE("No compile time logged, the benchmark objects are up to date. Clean the build tree and run the benchmark again.")
+  RETURN()
+ENDIF()
+
+FILE(STRINGS "${LOG_FILE}" lines)
+FOREACH(line ${lines})
+  MESSAGE("${line}")
+ENDFOREACH()
@@ -0,0 +1,89 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Compiler and linker launcher (RULE_LAUNCH_COMPILE and RULE_LAUNCH_LINK)
+// of the benchmark targets: run the command, then append its kind, its
+// duration and the size of the file it produced to a log.
+//
+// Usage: ctkPythonQtWrapperCompileLauncher <log-file> <kind> <command> [<arg> ...]
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  if (arguments.count() < 4)
+    {
+    fprintf(stderr, "Usage: ctkPythonQtWrapperCompileLauncher <log-file> <kind> <command> [<arg> ...]\n");
+    return EXIT_FAILURE;
+    }
+  QString logFilePath = arguments.at(1);
+  QString kind = arguments.at(2);
+  QString command = arguments.at(3);
+  QStringList commandArguments = arguments.mid(4);
+
+  QString outputFilePath;
+  int outputIndex = commandArguments.indexOf("-o");
+  if (outputIndex >= 0 && outputIndex + 1 < commandArguments.count())
+    {
+    outputFilePath = commandArguments.at(outputIndex + 1);
+    }
+
+  QProcess process;
+  process.setProcessChannelMode(QProcess::ForwardedChannels);
+  QTime time;
+  time.start();
+  process.start(command, commandArguments);
+  if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit)
+    {
+    fprintf(stderr, "error: Failed to run [%s]\n", qPrintable(command));
+    return EXIT_FAILURE;
+    }
+  int elapsed = time.elapsed();
+  if (process.exitCode() != 0)
+    {
+    return process.exitCode();
+    }
+
+  QFile logFile(logFilePath);
+  if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+    fprintf(stderr, "error: Failed to open [%s]\n", qPrintable(logFilePath));
+    return EXIT_FAILURE;
+    }
+  // kind, output, ms, output bytes
+  QTextStream stream(&logFile);
+  stream << kind << "\t" << QFileInfo(outputFilePath).fileName() << "\t" << elapsed
+         << "\t" << QFileInfo(outputFilePath).size() << "\n";
+  return EXIT_SUCCESS;
+}
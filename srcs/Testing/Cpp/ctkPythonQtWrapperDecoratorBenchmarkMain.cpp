@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver comparing the generic access to the members of a wrapped class
+// with the decorator slots generated by --decorators.
+//
+// Both resolve their meta-property or meta-method once, as PythonQt caches
+// them per class, so that only the calls are timed. The generic access
+// marshals the values through QVariant and goes through the meta-object of
+// the wrapped object. The decorators take the values with their C++ types.
+//
+// PythonQtWrapper_DECORATOR_HEADER is the generated header, provided by the
+// build.
+
+// Qt includes
+#include <QCoreApplication>
+#include <QMetaProperty>
+#include <QTime>
+#include <QVariant>
+
+// PythonQtStub includes
+#include "PythonQt.h"
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperDecoratorObject.h"
+#include PythonQtWrapper_DECORATOR_HEADER
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+typedef PythonQtWrapper_ctkPythonQtWrapperDecoratorObject Decorator;
+
+//-----------------------------------------------------------------------------
+int methodIndex(const QObject& object, const char* signature)
+{
+  int index = object.metaObject()->indexOfMethod(signature);
+  if (index < 0)
+    {
+    fprintf(stderr, "error: No method [%s] in [%s]\n", signature, object.metaObject()->className());
+    exit(EXIT_FAILURE);
+    }
+  return index;
+}
+
+//-----------------------------------------------------------------------------
+void printResult(const char* member, int calls, int generic, int decorated)
+{
+  // member, calls, generic ms, decorated ms
+  printf("decorators\t%s\t%d\t%d\t%d\n", member, calls, generic, decorated);
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  int calls = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (calls <= 0)
+    {
+    fprintf(stderr, "error: Invalid call count [%s]\n", argv[1]);
+    return EXIT_FAILURE;
+    }
+
+  ctkPythonQtWrapperDecoratorObject object;
+  ctkPythonQtWrapperDecoratorObject* objectPointer = &object;
+  Decorator decorator;
+
+  const QMetaObject* metaObject = object.metaObject();
+  QMetaProperty valueProperty = metaObject->property(metaObject->indexOfProperty("value"));
+  int genericAddIndex = methodIndex(object, "add(int,int)");
+
+  int getIndex = methodIndex(decorator, "py_get_value(ctkPythonQtWrapperDecoratorObject*)");
+  int setIndex = methodIndex(decorator, "py_set_value(ctkPythonQtWrapperDecoratorObject*,int)");
+  int addIndex = methodIndex(decorator, "add(ctkPythonQtWrapperDecoratorObject*,int,int)");
+
+  QTime time;
+  int generic = 0;
+  int decorated = 0;
+  qint64 genericSum = 0;
+  qint64 decoratedSum = 0;
+
+  // Property write
+  time.start();
+  for (int i = 0; i < calls; ++i)
+    {
+    valueProperty.write(&object, QVariant(i));
+    }
+  generic = time.restart();
+  for (int i = 0; i < calls; ++i)
+    {
+    void* arguments[] = { 0, &objectPointer, &i };
+    decorator.qt_metacall(QMetaObject::InvokeMetaMethod, setIndex, arguments);
+    }
+  decorated = time.elapsed();
+  printResult("py_set_value", calls, generic, decorated);
+
+  // Property read
+  time.start();
+  for (int i = 0; i < calls; ++i)
+    {
+    genericSum += valueProperty.read(&object).toInt();
+    }
+  generic = time.restart();
+  for (int i = 0; i < calls; ++i)
+    {
+    int value = 0;
+    void* arguments[] = { &value, &objectPointer };
+    decorator.qt_metacall(QMetaObject::InvokeMetaMethod, getIndex, arguments);
+    decoratedSum += value;
+    }
+  decorated = time.elapsed();
+  printResult("py_get_value", calls, generic, decorated);
+
+  // Q_INVOKABLE method
+  time.start();
+  for (int i = 0; i < calls; ++i)
+    {
+    QVariant a(i);
+    QVariant b(1);
+    QVariant sum(0);
+    void* arguments[] = { sum.data(), a.data(), b.data() };
+    object.qt_metacall(QMetaObject::InvokeMetaMethod, genericAddIndex, arguments);
+    genericSum += sum.toInt();
+    }
+  generic = time.restart();
+  for (int i = 0; i < calls; ++i)
+    {
+    int one = 1;
+    int sum = 0;
+    void* arguments[] = { &sum, &objectPointer, &i, &one };
+    decorator.qt_metacall(QMetaObject::InvokeMetaMethod, addIndex, arguments);
+    decoratedSum += sum;
+    }
+  decorated = time.elapsed();
+  printResult("add", calls, generic, decorated);
+
+  if (genericSum != decoratedSum)
+    {
+    fprintf(stderr, "error: Generic and decorated results differ\n");
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
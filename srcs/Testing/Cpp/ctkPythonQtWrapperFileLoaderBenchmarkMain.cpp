@@ -0,0 +1,143 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver timing the reads of a corpus by ctkPythonQtWrapperFileLoader, with
+// io_uring or with the thread pool, from a cold or a warm page cache.
+//
+// With "cold", the pages of every file are evicted before each run with
+// posix_fadvise(POSIX_FADV_DONTNEED). The kernel only drops the pages that
+// are clean and not mapped: on a file system which ignores the advice, or
+// where it is not available, "cold" measures a warm cache too.
+//
+// The results are printed and appended to a log, see
+// ctkPythonQtWrapperBenchmarkReport.cmake.
+//
+// Usage: ctkPythonQtWrapperFileLoaderBenchmark <log-file> <runs> <io_uring|threads> <cold|warm>
+//                                              <file> [<file> ...]
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+#include <QVector>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperFileLoader.h"
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#ifndef _WIN32
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+void evictFromPageCache(const QStringList& filePaths)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+  foreach(const QString& filePath, filePaths)
+    {
+    int fd = open(QFile::encodeName(filePath).constData(), O_RDONLY);
+    if (fd >= 0)
+      {
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+      }
+    }
+#else
+  Q_UNUSED(filePaths);
+#endif
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  int runs = arguments.count() >= 6 ? arguments.at(2).toInt() : 0;
+  QString backend = arguments.value(3);
+  QString cache = arguments.value(4);
+  if (runs <= 0 || (backend != "io_uring" && backend != "threads")
+      || (cache != "cold" && cache != "warm"))
+    {
+    fprintf(stderr, "Usage: ctkPythonQtWrapperFileLoaderBenchmark <log-file> <runs> <io_uring|threads> "
+            "<cold|warm> <file> [<file> ...]\n");
+    return EXIT_FAILURE;
+    }
+  QString logFilePath = arguments.at(1);
+  QStringList filePaths = arguments.mid(5);
+
+  ctkPythonQtWrapperFileLoader loader;
+  loader.setIoUringEnabled(backend == "io_uring");
+  QVector<QByteArray> contents;
+  QVector<bool> loaded;
+  QVector<int> elapsed(runs);
+  int total = 0;
+  qint64 bytes = 0;
+  for (int i = 0; i < runs; ++i)
+    {
+    if (cache == "cold")
+      {
+      evictFromPageCache(filePaths);
+      }
+    QTime time;
+    time.start();
+    loader.load(filePaths, contents, loaded);
+    elapsed[i] = time.elapsed();
+    total += elapsed[i];
+    if (loaded.contains(false))
+      {
+      fprintf(stderr, "error: Failed to read [%s]\n", qPrintable(filePaths.at(loaded.indexOf(false))));
+      return EXIT_FAILURE;
+      }
+    }
+  foreach(const QByteArray& content, contents)
+    {
+    bytes += content.size();
+    }
+  std::sort(elapsed.begin(), elapsed.end());
+  double median = runs % 2 ? elapsed[runs / 2]
+    : (elapsed[runs / 2 - 1] + elapsed[runs / 2]) / 2.0;
+
+  // The backend actually used, io_uring falls back to the threads if the
+  // kernel doesn't support it or the tree is built without it
+  QString label = loader.backendName() + (cache == "cold" ? "Cold" : "Warm");
+  // label, files, bytes, runs, total ms, median ms per run
+  QString line = QString("load\t%1\t%2\t%3\t%4\t%5\t%6").arg(label).arg(filePaths.count())
+      .arg(bytes).arg(runs).arg(total).arg(median, 0, 'f', 3);
+  printf("%s\n", qPrintable(line));
+
+  QFile logFile(logFilePath);
+  if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+    fprintf(stderr, "error: Failed to open [%s]\n", qPrintable(logFilePath));
+    return EXIT_FAILURE;
+    }
+  QTextStream stream(&logFile);
+  stream << line << "\n";
+  return EXIT_SUCCESS;
+}
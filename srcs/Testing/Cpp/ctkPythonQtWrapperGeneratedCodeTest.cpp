@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver checking that the code generated for the fixture headers compiles
+// against the PythonQt stub, and that its init function registers working
+// wrappers.
+//
+// PythonQtWrapper_TEST_INIT is the init function to call and
+// PythonQtWrapper_TEST_MODULE is 1 if it is the entry point of a module.
+// PythonQtWrapper_TEST_POLYMORPHIC and PythonQtWrapper_TEST_DECORATORS are
+// defined if the code has been generated with --polymorphic-handlers and
+// --decorators.
+
+// Qt includes
+#include <QCoreApplication>
+#include <QMetaObject>
+
+// PythonQtStub includes
+#include "PythonQt.h"
+
+// PythonQtWrapper includes
+#include "ctkFixtureDerivedObject.h"
+#include "ctkFixtureObject.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+// STD includes
+#include <cstring>
+
+#if PythonQtWrapper_TEST_MODULE
+void PythonQtWrapper_TEST_INIT(PyObject* module, const char* wrappingNamespace);
+#else
+void PythonQtWrapper_TEST_INIT(PyObject* module);
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+QObject* createWrapper(const char* className)
+{
+  PythonQtQObjectCreatorFunctionCB* creator = PythonQt::self()->wrapperCreator(className);
+  return creator ? static_cast<QObject*>(creator()) : 0;
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+#if PythonQtWrapper_TEST_MODULE
+  PythonQtWrapper_TEST_INIT(0, 0);
+#else
+  PythonQtWrapper_TEST_INIT(0);
+#endif
+  ctkPythonQtWrapperCheckMacro(PythonQt::self()->registerClassCount() == 4);
+
+  // The widgets need a QApplication to be created, only their wrapper is
+  // checked
+  const char* classNames[] =
+    {
+    "ctkFixtureObject", "ctkFixtureDerivedObject", "ctkFixtureWidget", "ctkFixtureNoParent"
+    };
+  for (unsigned int i = 0; i < sizeof(classNames) / sizeof(classNames[0]); ++i)
+    {
+    QObject* wrapper = createWrapper(classNames[i]);
+    ctkPythonQtWrapperCheckMacro(wrapper != 0);
+    ctkPythonQtWrapperCheckMacro(QByteArray(wrapper->metaObject()->className())
+                                 == QByteArray("PythonQtWrapper_") + classNames[i]);
+    delete wrapper;
+    }
+  ctkPythonQtWrapperCheckMacro(createWrapper("ctkFixtureAbstract") == 0);
+  ctkPythonQtWrapperCheckMacro(createWrapper("ctkFixtureNoQObject") == 0);
+
+  // Constructor and destructor slots
+  QObject* wrapper = createWrapper("ctkFixtureObject");
+  ctkFixtureObject* object = 0;
+  QObject* noParent = 0;
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "new_ctkFixtureObject",
+    Q_RETURN_ARG(ctkFixtureObject*, object), Q_ARG(QObject*, noParent)));
+  ctkPythonQtWrapperCheckMacro(object != 0);
+
+#ifdef PythonQtWrapper_TEST_DECORATORS
+  int value = 0;
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "py_set_value", Q_ARG(ctkFixtureObject*, object), Q_ARG(int, 3)));
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "py_get_value", Q_RETURN_ARG(int, value), Q_ARG(ctkFixtureObject*, object)));
+  ctkPythonQtWrapperCheckMacro(value == 3);
+  value = 0;
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "add", Q_RETURN_ARG(int, value),
+    Q_ARG(ctkFixtureObject*, object), Q_ARG(int, 1), Q_ARG(int, 2)));
+  ctkPythonQtWrapperCheckMacro(value == 3);
+  // Overload without the default argument
+  value = 0;
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "add", Q_RETURN_ARG(int, value),
+    Q_ARG(ctkFixtureObject*, object), Q_ARG(int, 5)));
+  ctkPythonQtWrapperCheckMacro(value == 6);
+#endif
+
+  ctkPythonQtWrapperCheckMacro(QMetaObject::invokeMethod(
+    wrapper, "delete_ctkFixtureObject", Q_ARG(ctkFixtureObject*, object)));
+  delete wrapper;
+
+#ifdef PythonQtWrapper_TEST_POLYMORPHIC
+  ctkFixtureDerivedObject derived;
+  ctkFixtureObject* base = &derived;
+  const char* className = 0;
+  void* ptr = PythonQt::self()->castDownIfPossible("ctkFixtureObject", base, &className);
+  ctkPythonQtWrapperCheckMacro(ptr == static_cast<void*>(&derived));
+  ctkPythonQtWrapperCheckMacro(className != 0
+                               && std::strcmp(className, "ctkFixtureDerivedObject") == 0);
+#endif
+
+  return EXIT_SUCCESS;
+}
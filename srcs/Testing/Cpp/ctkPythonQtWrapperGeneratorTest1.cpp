@@ -0,0 +1,190 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QBuffer>
+#include <QDir>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+QStringList fixtureHeaders(const QString& dataDirectory)
+{
+  QStringList headers;
+  headers << "ctkFixtureAbstract.h" << "ctkFixtureDerivedObject.h" << "ctkFixtureNoParent.h"
+          << "ctkFixtureNoQObject.h" << "ctkFixtureObject.h" << "ctkFixtureWidget.h";
+  QDir dir(dataDirectory);
+  for (int i = 0; i < headers.count(); ++i)
+    {
+    headers[i] = dir.filePath(headers.at(i));
+    }
+  return headers;
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperGeneratorTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperGeneratorTest1 <data-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QStringList headers = fixtureHeaders(argv[1]);
+
+  ctkPythonQtWrapper wrapper;
+  wrapper.setWrappingNamespace("org.commontk.test");
+  wrapper.setTargetName("ctkFixtures");
+  wrapper.setRejectionMessagesEnabled(false);
+  wrapper.setDecoratorsEnabled(true);
+  ctkPythonQtWrapperCheckMacro(wrapper.setInput(headers));
+  ctkPythonQtWrapperCheckMacro(wrapper.validateInputFiles() == 2);
+
+  // Verdicts, in input order
+  const QList<ctkPythonQtWrapperAnalysis>& analyses = wrapper.analyses();
+  ctkPythonQtWrapperCheckMacro(analyses.count() == 6);
+  ctkPythonQtWrapperCheckMacro(!analyses.at(0).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(0).Reason == "Contains a virtual pure method");
+  ctkPythonQtWrapperCheckMacro(analyses.at(1).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(1).ParentClassName == "QObject");
+  ctkPythonQtWrapperCheckMacro(analyses.at(1).BaseClassName == "ctkFixtureObject");
+  ctkPythonQtWrapperCheckMacro(analyses.at(2).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(2).ParentClassName.isEmpty());
+  ctkPythonQtWrapperCheckMacro(!analyses.at(3).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(3).Reason == "No Q_OBJECT macro");
+  ctkPythonQtWrapperCheckMacro(analyses.at(4).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(4).ParentClassName == "QObject");
+  ctkPythonQtWrapperCheckMacro(analyses.at(4).Members.Properties.count() == 1);
+  ctkPythonQtWrapperCheckMacro(analyses.at(4).Members.Methods.count() == 1);
+  ctkPythonQtWrapperCheckMacro(analyses.at(4).Members.Methods.at(0).DefaultArgumentCount == 1);
+  ctkPythonQtWrapperCheckMacro(analyses.at(5).Valid);
+  ctkPythonQtWrapperCheckMacro(analyses.at(5).ParentClassName == "QWidget");
+
+  // Check report
+  QBuffer report;
+  ctkPythonQtWrapperCheckMacro(report.open(QIODevice::WriteOnly));
+  ctkPythonQtWrapperCheckMacro(wrapper.writeCheckReport(&report));
+  QStringList lines = QString::fromLocal8Bit(report.data()).split('\n', QString::SkipEmptyParts);
+  ctkPythonQtWrapperCheckMacro(lines.count() == 7);
+  ctkPythonQtWrapperCheckMacro(lines.at(0).startsWith('#'));
+  ctkPythonQtWrapperCheckMacro(lines.at(1) == headers.at(0) + "\trejected\t\tContains a virtual pure method");
+  ctkPythonQtWrapperCheckMacro(lines.at(3) == headers.at(2) + "\taccepted\t\t");
+  ctkPythonQtWrapperCheckMacro(lines.at(6) == headers.at(5) + "\taccepted\tQWidget\t");
+
+  // A missing header is kept in the inputs and reported as rejected
+  QString missingHeader = QDir(argv[1]).filePath("ctkFixtureMissing.h");
+  ctkPythonQtWrapper missing;
+  missing.setRejectionMessagesEnabled(false);
+  missing.logger().setLevel(ctkPythonQtWrapperLogger::Error);
+  ctkPythonQtWrapperCheckMacro(!missing.setInput(QStringList() << missingHeader));
+  ctkPythonQtWrapperCheckMacro(missing.lastError() == missingHeader + " - File doesn't exist");
+  ctkPythonQtWrapperCheckMacro(missing.setInput(QStringList() << headers.at(4)));
+  ctkPythonQtWrapperCheckMacro(missing.inputFiles().count() == 2);
+  ctkPythonQtWrapperCheckMacro(missing.validateInputFiles() == 1);
+  ctkPythonQtWrapperCheckMacro(missing.analyses().at(0).Reason == "Failed to open file");
+  report.close();
+  report.setData(QByteArray());
+  ctkPythonQtWrapperCheckMacro(report.open(QIODevice::WriteOnly));
+  ctkPythonQtWrapperCheckMacro(missing.writeCheckReport(&report));
+  lines = QString::fromLocal8Bit(report.data()).split('\n', QString::SkipEmptyParts);
+  ctkPythonQtWrapperCheckMacro(lines.count() == 3);
+  ctkPythonQtWrapperCheckMacro(lines.at(1) == missingHeader + "\trejected\t\tFailed to open file");
+
+  // Generated code
+  QString header = wrapper.generateHeaderCode();
+  QString init = wrapper.generateInitCode();
+  ctkPythonQtWrapperCheckMacro(header.contains("#include \"ctkFixtureWidget.h\""));
+  // Rejected headers are neither included nor wrapped
+  ctkPythonQtWrapperCheckMacro(!header.contains("#include \"ctkFixtureAbstract.h\""));
+  ctkPythonQtWrapperCheckMacro(!header.contains("#include \"ctkFixtureNoQObject.h\""));
+  ctkPythonQtWrapperCheckMacro(!header.contains("PythonQtWrapper_ctkFixtureAbstract"));
+  ctkPythonQtWrapperCheckMacro(!header.contains("PythonQtWrapper_ctkFixtureNoQObject"));
+  ctkPythonQtWrapperCheckMacro(header.contains("class PythonQtWrapper_HIDDEN PythonQtWrapper_ctkFixtureObject"));
+  ctkPythonQtWrapperCheckMacro(header.contains("int py_get_value(ctkFixtureObject* theWrappedObject)"));
+  ctkPythonQtWrapperCheckMacro(header.contains("int add(ctkFixtureObject* theWrappedObject, int arg0, int arg1)"));
+  ctkPythonQtWrapperCheckMacro(header.contains("int add(ctkFixtureObject* theWrappedObject, int arg0) "
+                                               "{ return theWrappedObject->add(arg0); }"));
+  ctkPythonQtWrapperCheckMacro(header.contains(
+    "extern template void* PythonQtCreateObject<PythonQtWrapper_ctkFixtureWidget>();"));
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "template void* PythonQtCreateObject<PythonQtWrapper_ctkFixtureWidget>();"));
+  ctkPythonQtWrapperCheckMacro(init.contains("void PythonQt_init_org_commontk_test_ctkFixtures(PyObject* module)"));
+  ctkPythonQtWrapperCheckMacro(init.count("PythonQt::self()->registerClass(") == 4);
+
+  QMap<QString, QByteArray> outputs = wrapper.generateOutputBuffers();
+  ctkPythonQtWrapperCheckMacro(outputs.count() == 2);
+  ctkPythonQtWrapperCheckMacro(outputs.contains(
+    "generated_cpp/org_commontk_test_ctkFixtures/org_commontk_test_ctkFixtures0.h"));
+  ctkPythonQtWrapperCheckMacro(outputs.contains(
+    "generated_cpp/org_commontk_test_ctkFixtures/org_commontk_test_ctkFixtures_init.cpp"));
+
+  // Base classes: multiple and virtual inheritance, template base class and
+  // export macro
+  QDir data(argv[1]);
+  ctkPythonQtWrapper bases;
+  bases.setWrappingNamespace("org.commontk.test");
+  bases.setTargetName("ctkFixtureBases");
+  bases.setPolymorphicHandlersEnabled(true);
+  ctkPythonQtWrapperCheckMacro(bases.setInput(QStringList()
+    << data.filePath("ctkFixtureObject.h") << data.filePath("ctkFixtureMultipleBases.h")
+    << data.filePath("ctkFixtureVirtualBase.h") << data.filePath("ctkFixtureTemplateBase.h")
+    << data.filePath("ctkFixtureExported.h")));
+  ctkPythonQtWrapperCheckMacro(bases.validateInputFiles() == 0);
+  const QList<ctkPythonQtWrapperAnalysis>& baseAnalyses = bases.analyses();
+  ctkPythonQtWrapperCheckMacro(baseAnalyses.at(0).BaseClassName == "QObject");
+  ctkPythonQtWrapperCheckMacro(baseAnalyses.at(1).BaseClassName == "ctkFixtureObject");
+  ctkPythonQtWrapperCheckMacro(baseAnalyses.at(2).BaseClassName == "ctkFixtureObject");
+  ctkPythonQtWrapperCheckMacro(baseAnalyses.at(3).BaseClassName
+                               == "ctkFixtureHolder< ctkFixtureHolder<ctkFixtureObject> >");
+  ctkPythonQtWrapperCheckMacro(baseAnalyses.at(4).BaseClassName == "ctkFixtureObject");
+  QString baseClassName;
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapper::extractBaseClassName(
+    "class ctkFoo : virtual protected ctk::Bar\n{", "ctkFoo", baseClassName));
+  ctkPythonQtWrapperCheckMacro(baseClassName == "ctk::Bar");
+  ctkPythonQtWrapperCheckMacro(!ctkPythonQtWrapper::extractBaseClassName(
+    "class ctkFooBar : public QObject\n{", "ctkFoo", baseClassName));
+
+  // Only the wrapped base class gets a polymorphic handler, every wrapped
+  // class is in the hierarchy table
+  init = bases.generateInitCode();
+  ctkPythonQtWrapperCheckMacro(init.count("PythonQt::self()->addPolymorphicHandler(") == 1);
+  ctkPythonQtWrapperCheckMacro(init.contains("PythonQtWrapper_polymorphicHandler<ctkFixtureObject>"));
+  ctkPythonQtWrapperCheckMacro(init.count("PythonQtWrapper_downcast<") == 5);
+
+  // Split wrappers: only the classes with decorators are included by the
+  // header, the others are included by the init file
+  wrapper.setSplitWrappersEnabled(true);
+  header = wrapper.generateHeaderCode();
+  init = wrapper.generateInitCode();
+  ctkPythonQtWrapperCheckMacro(header.contains("#include \"ctkFixtureObject.h\""));
+  ctkPythonQtWrapperCheckMacro(header.contains("class ctkFixtureWidget;"));
+  ctkPythonQtWrapperCheckMacro(!header.contains("#include \"ctkFixtureWidget.h\""));
+  ctkPythonQtWrapperCheckMacro(!header.contains("return new ctkFixtureWidget(parent);"));
+  ctkPythonQtWrapperCheckMacro(init.contains("#include \"ctkFixtureWidget.h\""));
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "ctkFixtureWidget* PythonQtWrapper_ctkFixtureWidget::new_ctkFixtureWidget(QWidget* parent)"));
+
+  return EXIT_SUCCESS;
+}
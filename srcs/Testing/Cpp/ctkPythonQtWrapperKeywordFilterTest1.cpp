@@ -0,0 +1,211 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperKeywordFilter.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+typedef ctkPythonQtWrapperKeywordFilter Filter;
+
+//-----------------------------------------------------------------------------
+bool isReferenceSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+//-----------------------------------------------------------------------------
+// Straightforward search the implementations are checked against.
+int referenceScan(const QByteArray& data, int keywords)
+{
+  int found = 0;
+  if ((keywords & Filter::QObjectMacro) && data.contains("Q_OBJECT"))
+    {
+    found |= Filter::QObjectMacro;
+    }
+  if ((keywords & Filter::VirtualKeyword) && data.contains("virtual"))
+    {
+    found |= Filter::VirtualKeyword;
+    }
+  if (keywords & Filter::PureSpecifier)
+    {
+    for (int pos = data.indexOf('='); pos >= 0; pos = data.indexOf('=', pos + 1))
+      {
+      int i = pos + 1;
+      while (i < data.size() && isReferenceSpace(data.at(i)))
+        {
+        ++i;
+        }
+      if (data.mid(i, 1) == "0" || data.mid(i, 4) == "NULL")
+        {
+        found |= Filter::PureSpecifier;
+        break;
+        }
+      }
+    }
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+// Return false and print the buffer if an implementation disagrees with the
+// reference for any subset of the keywords.
+bool checkAgreement(const QByteArray& data, const QList<Filter::Implementation>& implementations)
+{
+  for (int keywords = 1; keywords <= Filter::AllKeywords; ++keywords)
+    {
+    int expected = referenceScan(data, keywords);
+    if (Filter::scan(data, keywords) != expected)
+      {
+      std::cerr << "scan() mismatch for keywords " << keywords
+                << " in \"" << data.toPercentEncoding().constData() << "\"" << std::endl;
+      return false;
+      }
+    for (int i = 0; i < implementations.count(); ++i)
+      {
+      if (Filter::scanWith(implementations.at(i), data.constData(), data.size(), keywords)
+          != expected)
+        {
+        std::cerr << "Implementation " << implementations.at(i) << " mismatch for keywords " << keywords
+                  << " in \"" << data.toPercentEncoding().constData() << "\"" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Same header as the benchmark corpus (see ctkPythonQtWrapperBenchmarkCorpus
+// in CMakeLists.txt).
+QByteArray corpusHeader(int index)
+{
+  QByteArray className = "ctkBenchmarkClass" + QByteArray::number(index);
+  QByteArray baseClass = index % 3 == 0 ? "QWidget" : "QObject";
+  QByteArray constructor = className + "() {}";
+  if (index % 3 != 2)
+    {
+    constructor = className + "(" + baseClass + "* parent = 0) : " + baseClass + "(parent) {}";
+    }
+  return "#ifndef __" + className + "_h\n"
+         "#define __" + className + "_h\n"
+         "\n"
+         "#include <" + baseClass + ">\n"
+         "\n"
+         "class " + className + " : public " + baseClass + "\n"
+         "{\n"
+         "  Q_OBJECT\n"
+         "public:\n"
+         "  " + constructor + "\n"
+         "};\n"
+         "\n"
+         "#endif\n";
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperKeywordFilterTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperKeywordFilterTest1 <data-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QList<Filter::Implementation> implementations;
+  implementations << Filter::ScalarImplementation;
+  if (Filter::isAvailable(Filter::Sse2Implementation))
+    {
+    implementations << Filter::Sse2Implementation;
+    }
+  if (Filter::isAvailable(Filter::Avx2Implementation))
+    {
+    implementations << Filter::Avx2Implementation;
+    }
+  std::cout << "Checking " << implementations.count() << " implementation(s), scan() uses "
+            << Filter::implementationName() << std::endl;
+
+  // Fixture headers
+  QDir dataDir(argv[1]);
+  QStringList fileNames = dataDir.entryList(QStringList() << "*.h", QDir::Files);
+  ctkPythonQtWrapperCheckMacro(!fileNames.isEmpty());
+  for (int i = 0; i < fileNames.count(); ++i)
+    {
+    QFile file(dataDir.filePath(fileNames.at(i)));
+    ctkPythonQtWrapperCheckMacro(file.open(QIODevice::ReadOnly));
+    ctkPythonQtWrapperCheckMacro(checkAgreement(file.readAll(), implementations));
+    }
+
+  // Benchmark corpus headers, and every prefix of one of them so that the
+  // lengths cover all the remainders modulo 16 and 32.
+  for (int index = 0; index < 30; ++index)
+    {
+    ctkPythonQtWrapperCheckMacro(checkAgreement(corpusHeader(index), implementations));
+    }
+  QByteArray header = corpusHeader(1);
+  for (int size = 0; size <= header.size(); ++size)
+    {
+    ctkPythonQtWrapperCheckMacro(checkAgreement(header.left(size), implementations));
+    }
+
+  // Every keyword at every offset across the first two 32 bytes blocks, in
+  // a buffer full of partial matches. The keyword is also truncated by the
+  // end of the buffer.
+  QByteArray filler;
+  while (filler.size() < 128)
+    {
+    filler += "Q_OBJEC virtua =x ";
+    }
+  QList<QByteArray> keywords;
+  keywords << "Q_OBJECT" << "virtual" << "= 0" << "=0" << "=NULL" << "= \t\r\n0"
+           << "=\f0" << "=\v0" << "=\f\vNULL";
+  for (int i = 0; i < keywords.count(); ++i)
+    {
+    const QByteArray& keyword = keywords.at(i);
+    for (int offset = 0; offset <= 70; ++offset)
+      {
+      QByteArray data = filler.left(offset) + keyword + filler.left(128 - offset);
+      ctkPythonQtWrapperCheckMacro(checkAgreement(data, implementations));
+      for (int size = offset; size <= offset + keyword.size(); ++size)
+        {
+        ctkPythonQtWrapperCheckMacro(checkAgreement(data.left(size), implementations));
+        }
+      }
+    }
+
+  // Form feed and vertical tab separate a pure specifier
+  ctkPythonQtWrapperCheckMacro(Filter::scan(QByteArray("virtual void f() =\f0;"))
+                               == (Filter::VirtualKeyword | Filter::PureSpecifier));
+  ctkPythonQtWrapperCheckMacro(Filter::scan(QByteArray("virtual void f() =\v 0;"))
+                               == (Filter::VirtualKeyword | Filter::PureSpecifier));
+  // ... as for the full check, which the prefilter must not skip
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapper::hasVirtualPureMethod("virtual void f() =\f0;"));
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapper::hasVirtualPureMethod("virtual void f() =\v 0;"));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperMembers.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperMethod method(const QString& returnType, const QString& name,
+                                const QStringList& parameterTypes, int defaultArgumentCount)
+{
+  ctkPythonQtWrapperMethod method;
+  method.ReturnType = returnType;
+  method.Name = name;
+  method.ParameterTypes = parameterTypes;
+  method.DefaultArgumentCount = defaultArgumentCount;
+  return method;
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperMembersTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperMembersTest1 <data-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QFile file(QDir(argv[1]).filePath("ctkFixtureMembers.h"));
+  ctkPythonQtWrapperCheckMacro(file.open(QIODevice::ReadOnly));
+  QString content = QTextStream(&file).readAll();
+
+  ctkPythonQtWrapperMembers members =
+      ctkPythonQtWrapperMembers::extract(content, "ctkFixtureMembers");
+
+  // Properties: the accessors which aren't public are dropped, the nested
+  // types are qualified
+  ctkPythonQtWrapperCheckMacro(members.Properties.count() == 3);
+  const ctkPythonQtWrapperProperty& title = members.Properties.at(0);
+  ctkPythonQtWrapperCheckMacro(title.Type == "QString");
+  ctkPythonQtWrapperCheckMacro(title.Name == "title");
+  ctkPythonQtWrapperCheckMacro(title.Read == "title");
+  ctkPythonQtWrapperCheckMacro(title.Write == "setTitle");
+  ctkPythonQtWrapperCheckMacro(members.Properties.at(1).Type == "ctkFixtureMembers::Mode");
+  ctkPythonQtWrapperCheckMacro(members.Properties.at(1).Write == "setMode");
+  ctkPythonQtWrapperCheckMacro(members.Properties.at(2).Read == "count");
+  ctkPythonQtWrapperCheckMacro(members.Properties.at(2).Write.isEmpty());
+
+  // Public invokables and slots, in declaration order
+  QList<ctkPythonQtWrapperMethod> expected;
+  expected << method("int", "scale", QStringList() << "int", 0)
+           << method("double", "scale", QStringList() << "double" << "double", 1)
+           << method("void", "setRange", QStringList() << "int" << "int", 2)
+           << method("QString", "format",
+                     QStringList() << "const QString&" << "const QList<int>&" << "int", 2)
+           << method("ctkFixtureMembers::RangeList", "ranges",
+                     QStringList() << "ctkFixtureMembers::Mode", 0)
+           << method("ctkFixtureMembers::Range", "range", QStringList() << "int", 0)
+           << method("void", "reset", QStringList(), 0);
+  ctkPythonQtWrapperCheckMacro(members.Methods.count() == expected.count());
+  for (int i = 0; i < expected.count(); ++i)
+    {
+    ctkPythonQtWrapperCheckMacro(members.Methods.at(i) == expected.at(i));
+    }
+
+  // One decorator per accessor, and per number of arguments
+  QString code = members.generateDecoratorCode("ctkFixtureMembers");
+  ctkPythonQtWrapperCheckMacro(code.contains(
+    "  ctkFixtureMembers::Mode py_get_mode(ctkFixtureMembers* theWrappedObject) "
+    "{ return theWrappedObject->mode(); }\n"));
+  ctkPythonQtWrapperCheckMacro(code.contains(
+    "  void py_set_title(ctkFixtureMembers* theWrappedObject, QString value) "
+    "{ theWrappedObject->setTitle(value); }\n"));
+  ctkPythonQtWrapperCheckMacro(!code.contains("py_set_count"));
+  ctkPythonQtWrapperCheckMacro(code.count(" scale(ctkFixtureMembers* theWrappedObject") == 3);
+  ctkPythonQtWrapperCheckMacro(code.contains(
+    "  void setRange(ctkFixtureMembers* theWrappedObject) { theWrappedObject->setRange(); }\n"));
+  ctkPythonQtWrapperCheckMacro(code.contains(
+    "  QString format(ctkFixtureMembers* theWrappedObject, const QString& arg0) "
+    "{ return theWrappedObject->format(arg0); }\n"));
+  // 5 accessors, then the overloads of each method
+  ctkPythonQtWrapperCheckMacro(code.count("\n") == 5 + 1 + 2 + 3 + 3 + 1 + 1 + 1);
+
+  // A class without members, and a class not declared by the content
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapperMembers::extract(
+    "class ctkFoo : public QObject\n{\n  Q_OBJECT\npublic:\n  ctkFoo();\n};\n", "ctkFoo").isEmpty());
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapperMembers::extract(content, "ctkFoo").isEmpty());
+
+  return EXIT_SUCCESS;
+}
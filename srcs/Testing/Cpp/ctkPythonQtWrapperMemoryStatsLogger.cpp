@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver running PythonQtWrapper once with --memstats and collecting the
+// allocations and the peak resident set size it reports after each phase.
+//
+// The lines are prefixed with <label>, printed and appended to a log, see
+// ctkPythonQtWrapperBenchmarkReport.cmake. Without the allocation hooks
+// (PythonQtWrapper_USE_MEMORY_HOOKS), the allocation columns are "-".
+//
+// Usage: ctkPythonQtWrapperMemoryStatsLogger <log-file> <label> <executable> [<argument> ...]
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  if (arguments.count() < 4)
+    {
+    fprintf(stderr, "Usage: ctkPythonQtWrapperMemoryStatsLogger <log-file> <label> <executable> "
+            "[<argument> ...]\n");
+    return EXIT_FAILURE;
+    }
+  QString logFilePath = arguments.at(1);
+  QString label = arguments.at(2);
+  QString executable = arguments.at(3);
+  QStringList executableArguments = arguments.mid(4);
+  executableArguments << "--memstats";
+
+  QProcess process;
+  process.start(executable, executableArguments);
+  if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit
+      || process.exitCode() != 0)
+    {
+    fprintf(stderr, "%s", process.readAllStandardError().constData());
+    fprintf(stderr, "error: Failed to run [%s]\n", qPrintable(executable));
+    return EXIT_FAILURE;
+    }
+
+  // label, phase, allocation count, allocated bytes, peak resident set size
+  QStringList lines;
+  QList<QByteArray> output = process.readAllStandardError().split('\n');
+  foreach(const QByteArray& outputLine, output)
+    {
+    if (outputLine.startsWith("memstats\t"))
+      {
+      lines << QString("memstats\t%1\t%2").arg(label)
+          .arg(QString::fromLatin1(outputLine.mid(9).trimmed()));
+      }
+    }
+  if (lines.isEmpty())
+    {
+    fprintf(stderr, "error: [%s] reported no memory statistics\n", qPrintable(executable));
+    return EXIT_FAILURE;
+    }
+
+  QFile logFile(logFilePath);
+  if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+    fprintf(stderr, "error: Failed to open [%s]\n", qPrintable(logFilePath));
+    return EXIT_FAILURE;
+    }
+  QTextStream stream(&logFile);
+  foreach(const QString& line, lines)
+    {
+    printf("%s\n", qPrintable(line));
+    stream << line << "\n";
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperModule.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+void addTargets(ctkPythonQtWrapperModule& module, const QDir& data)
+{
+  ctkPythonQtWrapper* objects = module.addTarget("org.commontk.test", "ctkFixtureObjects");
+  objects->setRejectionMessagesEnabled(false);
+  objects->setInput(QStringList()
+                    << data.filePath("ctkFixtureObject.h")
+                    << data.filePath("ctkFixtureDerivedObject.h")
+                    << data.filePath("ctkFixtureAbstract.h"));
+  ctkPythonQtWrapper* widgets = module.addTarget("org.commontk.test", "ctkFixtureWidgets");
+  widgets->setRejectionMessagesEnabled(false);
+  widgets->setInput(QStringList()
+                    << data.filePath("ctkFixtureWidget.h")
+                    << data.filePath("ctkFixtureNoParent.h")
+                    << data.filePath("ctkFixtureNoQObject.h"));
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperModuleTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperModuleTest1 <data-directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir data(argv[1]);
+
+  // One header and init file per target, and the module init file
+  ctkPythonQtWrapperModule module;
+  module.setWrappingNamespace("org.commontk.test");
+  module.setName("ctkFixtures");
+  addTargets(module, data);
+  ctkPythonQtWrapperCheckMacro(module.targets().count() == 2);
+  ctkPythonQtWrapperCheckMacro(module.validateInputFiles() == 2);
+
+  QMap<QString, QByteArray> outputs = module.generateOutputBuffers();
+  ctkPythonQtWrapperCheckMacro(outputs.count() == 5);
+  ctkPythonQtWrapperCheckMacro(outputs.contains(
+    "generated_cpp/org_commontk_test_ctkFixtureObjects/org_commontk_test_ctkFixtureObjects0.h"));
+  ctkPythonQtWrapperCheckMacro(outputs.contains(
+    "generated_cpp/org_commontk_test_ctkFixtureWidgets/org_commontk_test_ctkFixtureWidgets_init.cpp"));
+  QString initKey = "generated_cpp/org_commontk_test_ctkFixtures/org_commontk_test_ctkFixtures_init.cpp";
+  ctkPythonQtWrapperCheckMacro(outputs.contains(initKey));
+  QString init = QString::fromLocal8Bit(outputs.value(initKey));
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "void PythonQt_init_org_commontk_test_ctkFixtures(PyObject* module, const char* wrappingNamespace)"));
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "PythonQtWrapper_HIDDEN void PythonQt_init_org_commontk_test_ctkFixtureObjects(PyObject* module);"));
+  ctkPythonQtWrapperCheckMacro(init.contains("    PythonQt_init_org_commontk_test_ctkFixtureWidgets(module);"));
+  ctkPythonQtWrapperCheckMacro(!init.contains("registerClass("));
+
+  // Unity build: the module header and init file only
+  ctkPythonQtWrapperModule unity;
+  unity.setWrappingNamespace("org.commontk.test");
+  unity.setName("ctkFixtures");
+  unity.setUnityBuild(true);
+  addTargets(unity, data);
+
+  outputs = unity.generateOutputBuffers();
+  ctkPythonQtWrapperCheckMacro(outputs.count() == 2);
+  QString headerKey = "generated_cpp/org_commontk_test_ctkFixtures/org_commontk_test_ctkFixtures0.h";
+  ctkPythonQtWrapperCheckMacro(outputs.contains(headerKey));
+  ctkPythonQtWrapperCheckMacro(outputs.contains(initKey));
+  QString header = QString::fromLocal8Bit(outputs.value(headerKey));
+  init = QString::fromLocal8Bit(outputs.value(initKey));
+  ctkPythonQtWrapperCheckMacro(header.count("class PythonQtWrapper_HIDDEN PythonQtWrapper_") == 4);
+  ctkPythonQtWrapperCheckMacro(header.count("#include <PythonQt.h>") == 1);
+  ctkPythonQtWrapperCheckMacro(init.contains("#include \"org_commontk_test_ctkFixtures0.h\""));
+  ctkPythonQtWrapperCheckMacro(init.count("PythonQt::self()->registerClass(") == 4);
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "void PythonQt_init_org_commontk_test_ctkFixtureWidgets(PyObject* module)"));
+
+  // A class wrapped by two targets can't be merged into a unity build
+  ctkPythonQtWrapperModule duplicates;
+  duplicates.setWrappingNamespace("org.commontk.test");
+  duplicates.setName("ctkFixtures");
+  duplicates.setUnityBuild(true);
+  addTargets(duplicates, data);
+  ctkPythonQtWrapper* other = duplicates.addTarget("org.commontk.test", "ctkFixtureOthers");
+  other->setRejectionMessagesEnabled(false);
+  other->setInput(QStringList() << data.filePath("ctkFixtureObject.h"));
+  ctkPythonQtWrapperCheckMacro(duplicates.generateOutputBuffers().isEmpty());
+  ctkPythonQtWrapperCheckMacro(duplicates.lastError().contains(
+    "ctkFixtureObject (org.commontk.test ctkFixtureObjects and org.commontk.test ctkFixtureOthers)"));
+
+  return EXIT_SUCCESS;
+}
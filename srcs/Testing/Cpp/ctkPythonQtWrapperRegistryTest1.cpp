@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperRegistry.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperRegistryTest1(int argc, char* argv[])
+{
+  if (argc < 3)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperRegistryTest1 <data-directory> <temporary-directory>"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir data(argv[1]);
+  QDir temporary(argv[2]);
+  ctkPythonQtWrapperCheckMacro(temporary.mkpath("."));
+  QString registryFile = temporary.filePath("ctkPythonQtWrapperRegistryTest1.txt");
+  QFile::remove(registryFile);
+
+  // ctkFixtureObject.h is listed by both targets, the first one owns it
+  ctkPythonQtWrapper first;
+  first.setWrappingNamespace("org.commontk.test");
+  first.setTargetName("ctkFirst");
+  first.setRegistryFile(registryFile);
+  first.setInput(QStringList() << data.filePath("ctkFixtureObject.h"));
+  ctkPythonQtWrapperCheckMacro(first.updateRegistry());
+  ctkPythonQtWrapperCheckMacro(first.externalClasses().isEmpty());
+
+  ctkPythonQtWrapper second;
+  second.setWrappingNamespace("org.commontk.test");
+  second.setTargetName("ctkSecond");
+  second.setRegistryFile(registryFile);
+  second.setInput(QStringList()
+                  << data.filePath("ctkFixtureObject.h")
+                  << data.filePath("ctkFixtureWidget.h"));
+  ctkPythonQtWrapperCheckMacro(second.updateRegistry());
+  ctkPythonQtWrapperCheckMacro(second.externalClasses().count() == 1);
+  ctkPythonQtWrapperCheckMacro(second.externalClasses().value("ctkFixtureObject")
+                               == "org.commontk.test ctkFirst");
+
+  QString header = second.generateHeaderCode();
+  QString init = second.generateInitCode();
+  ctkPythonQtWrapperCheckMacro(!header.contains("#include \"ctkFixtureObject.h\""));
+  ctkPythonQtWrapperCheckMacro(!header.contains("PythonQtWrapper_ctkFixtureObject"));
+  ctkPythonQtWrapperCheckMacro(header.contains("PythonQtWrapper_ctkFixtureWidget"));
+  ctkPythonQtWrapperCheckMacro(init.contains(
+    "// ctkFixtureObject is wrapped and registered by org.commontk.test ctkFirst"));
+  ctkPythonQtWrapperCheckMacro(init.count("PythonQt::self()->registerClass(") == 1);
+
+  // Regenerating the owner keeps the ownership
+  ctkPythonQtWrapperCheckMacro(first.updateRegistry());
+  ctkPythonQtWrapperCheckMacro(first.externalClasses().isEmpty());
+
+  ctkPythonQtWrapperRegistry registry(registryFile);
+  QString wrappingNamespace;
+  QString targetName;
+  ctkPythonQtWrapperCheckMacro(registry.open());
+  ctkPythonQtWrapperCheckMacro(registry.owner("ctkFixtureObject", wrappingNamespace, targetName));
+  ctkPythonQtWrapperCheckMacro(targetName == "ctkFirst");
+  ctkPythonQtWrapperCheckMacro(registry.classes("org.commontk.test", "ctkSecond")
+                               == QStringList("ctkFixtureWidget"));
+  ctkPythonQtWrapperCheckMacro(registry.users("ctkFixtureObject")
+                               == QStringList("org.commontk.test ctkSecond"));
+  ctkPythonQtWrapperCheckMacro(registry.usedClasses("org.commontk.test", "ctkSecond")
+                               == QStringList("ctkFixtureObject"));
+  ctkPythonQtWrapperCheckMacro(registry.close());
+
+  // A target no longer listing a class releases it, and reports the
+  // targets which still list it
+  ctkPythonQtWrapper released;
+  released.setWrappingNamespace("org.commontk.test");
+  released.setTargetName("ctkFirst");
+  released.setRegistryFile(registryFile);
+  released.setInput(QStringList() << data.filePath("ctkFixtureNoParent.h"));
+  ctkPythonQtWrapperCheckMacro(released.updateRegistry());
+  ctkPythonQtWrapperCheckMacro(released.releasedClasses().count() == 1);
+  ctkPythonQtWrapperCheckMacro(released.releasedClasses().value("ctkFixtureObject")
+                               == QStringList("org.commontk.test ctkSecond"));
+
+  ctkPythonQtWrapperCheckMacro(registry.open());
+  ctkPythonQtWrapperCheckMacro(!registry.owner("ctkFixtureObject", wrappingNamespace, targetName));
+  ctkPythonQtWrapperCheckMacro(registry.users("ctkFixtureObject").isEmpty());
+  ctkPythonQtWrapperCheckMacro(registry.classes("org.commontk.test", "ctkFirst")
+                               == QStringList("ctkFixtureNoParent"));
+  ctkPythonQtWrapperCheckMacro(registry.close());
+
+  // Generated again, the user takes the class over
+  ctkPythonQtWrapperCheckMacro(second.updateRegistry());
+  ctkPythonQtWrapperCheckMacro(second.externalClasses().isEmpty());
+  ctkPythonQtWrapperCheckMacro(registry.open());
+  ctkPythonQtWrapperCheckMacro(registry.owner("ctkFixtureObject", wrappingNamespace, targetName));
+  ctkPythonQtWrapperCheckMacro(targetName == "ctkSecond");
+  ctkPythonQtWrapperCheckMacro(registry.usedClasses("org.commontk.test", "ctkSecond").isEmpty());
+  ctkPythonQtWrapperCheckMacro(registry.close());
+
+  QFile::remove(registryFile);
+  return EXIT_SUCCESS;
+}
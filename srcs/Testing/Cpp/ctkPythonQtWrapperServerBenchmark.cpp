@@ -0,0 +1,172 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver comparing a parallel build running PythonQtWrapper in-process with
+// one forwarding the same command lines to a server (--serve / --connect).
+//
+// The server handles one request at a time: <clients> generators are run
+// at once, as by make -j<clients>, and the clients which find it busy run
+// in-process. The median wall clock time of <runs> such rounds, and the
+// number of clients which fell back to in-process, are printed and appended
+// to a log, see ctkPythonQtWrapperBenchmarkReport.cmake. Every client writes
+// to its own subdirectory of <output-dir>. The socket is created in the
+// temporary directory, build trees may exceed the length of a socket path.
+//
+// Usage: ctkPythonQtWrapperServerBenchmark <log-file> <runs> <clients> <output-dir>
+//          <executable> [<argument> ...]
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+#include <QVector>
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Run \a clients processes at once, each with its own output directory, and
+// return the elapsed wall clock time, or -1 on failure. The clients which ran
+// in-process after trying the server are added to \a fallbacks.
+int runRound(const QString& executable, const QStringList& arguments,
+             int clients, const QString& outputDir, int& fallbacks)
+{
+  QTime time;
+  time.start();
+  QList<QProcess*> processes;
+  for (int i = 0; i < clients; ++i)
+    {
+    QString clientOutputDir = QString("%1/%2").arg(outputDir).arg(i);
+    QDir().mkpath(clientOutputDir);
+    QProcess* process = new QProcess;
+    process->start(executable, QStringList(arguments) << "--output-dir" << clientOutputDir);
+    processes << process;
+    }
+  bool succeeded = true;
+  foreach(QProcess* process, processes)
+    {
+    if (!process->waitForFinished(-1) || process->exitStatus() != QProcess::NormalExit
+        || process->exitCode() != 0)
+      {
+      fprintf(stderr, "%s", process->readAllStandardError().constData());
+      succeeded = false;
+      }
+    else if (process->readAllStandardError().contains(" - Running in-process"))
+      {
+      ++fallbacks;
+      }
+    }
+  int elapsed = time.elapsed();
+  qDeleteAll(processes);
+  return succeeded ? elapsed : -1;
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  int runs = arguments.count() >= 6 ? arguments.at(2).toInt() : 0;
+  int clients = arguments.count() >= 6 ? arguments.at(3).toInt() : 0;
+  if (runs <= 0 || clients <= 0)
+    {
+    fprintf(stderr, "Usage: ctkPythonQtWrapperServerBenchmark <log-file> <runs> <clients> "
+            "<output-dir> <executable> [<argument> ...]\n");
+    return EXIT_FAILURE;
+    }
+  QString logFilePath = arguments.at(1);
+  QString outputDir = arguments.at(4);
+  QString executable = arguments.at(5);
+  QStringList executableArguments = arguments.mid(6);
+  QString socketPath = QString("%1/ctkPythonQtWrapperServerBenchmark-%2.sock")
+    .arg(QDir::tempPath()).arg(QCoreApplication::applicationPid());
+
+  QProcess server;
+  server.setProcessChannelMode(QProcess::ForwardedChannels);
+  server.start(executable, QStringList() << "--serve" << socketPath);
+  // Wait for the socket, the server exiting meanwhile is a failure
+  for (int i = 0; i < 200 && !QFile::exists(socketPath); ++i)
+    {
+    if (server.waitForFinished(50))
+      {
+      fprintf(stderr, "error: Failed to start the server on [%s]\n", qPrintable(socketPath));
+      return EXIT_FAILURE;
+      }
+    }
+
+  QStringList labels = QStringList() << "InProcess" << "Server";
+  QStringList lines;
+  foreach(const QString& label, labels)
+    {
+    QStringList clientArguments = executableArguments;
+    if (label == "Server")
+      {
+      // --verbose reports the fallbacks to in-process
+      clientArguments << "--connect" << socketPath << "--verbose";
+      }
+    QVector<int> elapsed(runs);
+    int fallbacks = 0;
+    for (int i = 0; i < runs; ++i)
+      {
+      elapsed[i] = runRound(executable, clientArguments, clients,
+                            QString("%1/%2").arg(outputDir).arg(label), fallbacks);
+      if (elapsed[i] < 0)
+        {
+        fprintf(stderr, "error: Failed to run [%s]\n", qPrintable(executable));
+        server.kill();
+        server.waitForFinished(-1);
+        return EXIT_FAILURE;
+        }
+      }
+    std::sort(elapsed.begin(), elapsed.end());
+    double median = runs % 2 ? elapsed[runs / 2]
+      : (elapsed[runs / 2 - 1] + elapsed[runs / 2]) / 2.0;
+    // label, clients, runs, median ms per round, clients run in-process
+    lines << QString("server\t%1\t%2\t%3\t%4\t%5").arg(label).arg(clients).arg(runs)
+        .arg(median, 0, 'f', 3).arg(fallbacks);
+    }
+  server.kill();
+  server.waitForFinished(-1);
+  QFile::remove(socketPath);
+
+  QFile logFile(logFilePath);
+  if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+    fprintf(stderr, "error: Failed to open [%s]\n", qPrintable(logFilePath));
+    return EXIT_FAILURE;
+    }
+  QTextStream stream(&logFile);
+  foreach(const QString& line, lines)
+    {
+    printf("%s\n", qPrintable(line));
+    stream << line << "\n";
+    }
+  return EXIT_SUCCESS;
+}
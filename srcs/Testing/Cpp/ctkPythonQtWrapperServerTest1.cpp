@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperServer.h"
+#include "ctkPythonQtWrapperTesting.h"
+
+// STD includes
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Print the first argument on the standard output and "error" on the
+// standard error, and exit with the number of arguments.
+class EchoHandler : public ctkPythonQtWrapperServer::Handler
+{
+public:
+  virtual int handle(const QStringList& arguments)
+  {
+    fprintf(stdout, "%s\n", qPrintable(arguments.value(1)));
+    fprintf(stderr, "error\n");
+    return arguments.count();
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Forward \a arguments with the standard output and error of the process
+// redirected to \a outputFile and \a errorFile.
+int forwardRedirected(const QString& socketPath, const QStringList& arguments,
+                      const QString& outputFile, const QString& errorFile,
+                      QString& errorString)
+{
+  fflush(stdout);
+  fflush(stderr);
+  int output = ::open(QFile::encodeName(outputFile).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  int error = ::open(QFile::encodeName(errorFile).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  int savedOutput = ::dup(STDOUT_FILENO);
+  int savedError = ::dup(STDERR_FILENO);
+  ::dup2(output, STDOUT_FILENO);
+  ::dup2(error, STDERR_FILENO);
+  ::close(output);
+  ::close(error);
+  int exitCode = ctkPythonQtWrapperServer::forward(socketPath, arguments, errorString);
+  ::dup2(savedOutput, STDOUT_FILENO);
+  ::dup2(savedError, STDERR_FILENO);
+  ::close(savedOutput);
+  ::close(savedError);
+  return exitCode;
+}
+
+//-----------------------------------------------------------------------------
+QByteArray readFile(const QString& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return QByteArray();
+    }
+  return file.readAll();
+}
+
+//-----------------------------------------------------------------------------
+// Connect to \a socketPath and wait for the greeting: the server then waits
+// for the request of this client, which never comes.
+int connectWithoutRequest(const QString& socketPath)
+{
+  QByteArray path = QFile::encodeName(socketPath);
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.constData(), sizeof(address.sun_path) - 1);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  char greeting[4];
+  if (fd < 0
+      || ::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0
+      || ::recv(fd, greeting, sizeof(greeting), MSG_WAITALL) != sizeof(greeting))
+    {
+    if (fd >= 0)
+      {
+      ::close(fd);
+      }
+    return -1;
+    }
+  return fd;
+}
+
+//-----------------------------------------------------------------------------
+int runClients(const QString& socketPath, const QDir& temporary)
+{
+  QString outputFile = temporary.filePath("ctkPythonQtWrapperServerTest1.out");
+  QString errorFile = temporary.filePath("ctkPythonQtWrapperServerTest1.err");
+  QStringList arguments = QStringList() << "PythonQtWrapper" << "hello";
+  QString errorString;
+
+  // The request writes to the output and error of the client, and its exit
+  // code is the one of the client
+  ctkPythonQtWrapperCheckMacro(
+    forwardRedirected(socketPath, arguments, outputFile, errorFile, errorString) == 2);
+  ctkPythonQtWrapperCheckMacro(readFile(outputFile) == "hello\n");
+  ctkPythonQtWrapperCheckMacro(readFile(errorFile) == "error\n");
+
+  // The server is busy with a client which doesn't send its request: the
+  // other clients don't wait for it
+  int stalledFd = connectWithoutRequest(socketPath);
+  ctkPythonQtWrapperCheckMacro(stalledFd >= 0);
+  ctkPythonQtWrapperCheckMacro(
+    forwardRedirected(socketPath, arguments, outputFile, errorFile, errorString) == -1);
+  ctkPythonQtWrapperCheckMacro(errorString.endsWith(" is busy"));
+
+  // ... and the server drops it after a while
+  struct pollfd descriptor;
+  descriptor.fd = stalledFd;
+  descriptor.events = POLLIN;
+  descriptor.revents = 0;
+  char byte;
+  bool dropped = ::poll(&descriptor, 1, 10000) > 0 && ::recv(stalledFd, &byte, 1, 0) == 0;
+  ::close(stalledFd);
+  ctkPythonQtWrapperCheckMacro(dropped);
+  ctkPythonQtWrapperCheckMacro(
+    forwardRedirected(socketPath, arguments, outputFile, errorFile, errorString) == 2);
+
+  return EXIT_SUCCESS;
+}
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperServerTest1(int argc, char* argv[])
+{
+  if (argc < 3)
+    {
+    std::cerr << "Usage: ctkPythonQtWrapperServerTest1 <data-directory> <temporary-directory>"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  QDir temporary(argv[2]);
+  ctkPythonQtWrapperCheckMacro(temporary.mkpath("."));
+  // Build trees may exceed the length of a socket path
+  QString socketPath = QString("%1/ctkPythonQtWrapperServerTest1-%2.sock")
+    .arg(QDir::tempPath()).arg(::getpid());
+
+  // Without server, the client runs the request in-process
+  QString errorString;
+  ctkPythonQtWrapperCheckMacro(ctkPythonQtWrapperServer::forward(
+    socketPath, QStringList() << "PythonQtWrapper", errorString) == -1);
+  ctkPythonQtWrapperCheckMacro(errorString.startsWith("No server listening on "));
+
+  // The requests replace the standard descriptors of the whole process: the
+  // server runs in a child process
+  ctkPythonQtWrapperServer server;
+  ctkPythonQtWrapperCheckMacro(server.listen(socketPath));
+  pid_t pid = ::fork();
+  ctkPythonQtWrapperCheckMacro(pid >= 0);
+  if (pid == 0)
+    {
+    EchoHandler handler;
+    server.exec(&handler);
+    ::_exit(EXIT_FAILURE);
+    }
+  int result = runClients(socketPath, temporary);
+  ::kill(pid, SIGTERM);
+  ::waitpid(pid, 0, 0);
+  return result;
+}
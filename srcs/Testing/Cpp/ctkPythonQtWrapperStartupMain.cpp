@@ -0,0 +1,50 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Driver of the start-up benchmark: call the init functions of the wrapper
+// libraries it is linked against, either one per target or the single one
+// of a merged module, and check that every class got registered.
+//
+// PythonQtWrapper_STARTUP_CALLS_HEADER, PythonQtWrapper_STARTUP_MODE and
+// PythonQtWrapper_STARTUP_CLASS_COUNT are provided by the build.
+
+// PythonQtStub includes
+#include "PythonQt.h"
+
+// PythonQtWrapper includes
+#include PythonQtWrapper_STARTUP_CALLS_HEADER
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------
+int main(int, char*[])
+{
+  PythonQtWrapper_STARTUP_CALLS
+
+  if (PythonQt::self()->registerClassCount() != PythonQtWrapper_STARTUP_CLASS_COUNT)
+    {
+    fprintf(stderr, "error: %s - %d classes registered, %d expected\n", PythonQtWrapper_STARTUP_MODE,
+            PythonQt::self()->registerClassCount(), PythonQtWrapper_STARTUP_CLASS_COUNT);
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Run a command several times and print its median and average wall clock
+// times, from the process creation to its exit, including the loading of
+// the shared libraries it depends on.
+//
+// Usage: ctkPythonQtWrapperStartupTimer <runs> <label> <executable> [<argument> ...]
+
+// Qt includes
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStringList>
+#include <QTime>
+#include <QVector>
+
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  int runs = arguments.count() >= 4 ? arguments.at(1).toInt() : 0;
+  if (runs <= 0)
+    {
+    fprintf(stderr, "Usage: ctkPythonQtWrapperStartupTimer <runs> <label> <executable> [<argument> ...]\n");
+    return EXIT_FAILURE;
+    }
+  QString label = arguments.at(2);
+  QString executable = arguments.at(3);
+  QStringList executableArguments = arguments.mid(4);
+
+  QVector<int> elapsed(runs);
+  int total = 0;
+  for (int i = 0; i < runs; ++i)
+    {
+    QTime time;
+    time.start();
+    QProcess process;
+    // The output, e.g. of --help, would drown the results
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(executable, executableArguments);
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit
+        || process.exitCode() != 0)
+      {
+      fprintf(stderr, "%s", process.readAll().constData());
+      fprintf(stderr, "error: Failed to run [%s]\n", qPrintable(executable));
+      return EXIT_FAILURE;
+      }
+    elapsed[i] = time.elapsed();
+    total += elapsed[i];
+    }
+  std::sort(elapsed.begin(), elapsed.end());
+  double median = runs % 2 ? elapsed[runs / 2]
+    : (elapsed[runs / 2 - 1] + elapsed[runs / 2]) / 2.0;
+
+  // label, runs, total ms, median ms per run, average ms per run
+  printf("startup\t%s\t%d\t%d\t%.3f\t%.3f\n", qPrintable(label),
+         runs, total, median, static_cast<double>(total) / runs);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,38 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperTesting_h
+#define __ctkPythonQtWrapperTesting_h
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+/// Print the failed \a condition and make the test function return
+/// EXIT_FAILURE.
+#define ctkPythonQtWrapperCheckMacro(condition)                         \
+  if (!(condition))                                                     \
+    {                                                                   \
+    std::cerr << __FILE__ << ":" << __LINE__                            \
+              << ": check failed: " #condition << std::endl;            \
+    return EXIT_FAILURE;                                                \
+    }
+
+#endif
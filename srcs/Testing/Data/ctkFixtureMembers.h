@@ -0,0 +1,101 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureMembers_h
+#define __ctkFixtureMembers_h
+
+// Qt includes
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#define CTK_FIXTURE_DECLARE_PRIVATE(Class) friend class Class##Private;
+#define CTK_FIXTURE_DISABLE_COPY(Class) Class(const Class&); void operator=(const Class&);
+
+class ctkFixtureMembersPrivate;
+
+// Members scanned for the decorators. Only analysed, see
+// ctkPythonQtWrapperMembersTest1.
+class ctkFixtureMembers : public QObject
+{
+  Q_OBJECT
+  // Macro without a trailing semicolon
+  CTK_FIXTURE_DECLARE_PRIVATE(ctkFixtureMembers)
+  Q_ENUMS(Mode)
+  Q_PROPERTY(QString title READ title WRITE setTitle NOTIFY titleChanged)
+  Q_PROPERTY(Mode mode READ mode WRITE setMode)
+  Q_PROPERTY(int count READ count WRITE setCount DESIGNABLE false)
+public:
+  ctkFixtureMembers(QObject* parent = 0);
+  virtual ~ctkFixtureMembers();
+
+  enum Mode
+    {
+    Fast,
+    Slow
+    };
+  struct Range
+    {
+    int Minimum;
+    int Maximum;
+    int width()const { return this->Maximum - this->Minimum; }
+    };
+  typedef QList<Range> RangeList;
+
+  QString title()const;
+  void setTitle(const QString& newTitle);
+  Mode mode()const;
+  void setMode(Mode newMode);
+  int count()const;
+
+  CTK_FIXTURE_DISABLE_COPY(ctkFixtureMembers)
+
+  /* Overloads; */
+  Q_INVOKABLE int scale(int value)const;
+  Q_INVOKABLE double scale(double value, double factor = 2.)const;
+
+  // Default arguments, with commas and brackets
+  Q_INVOKABLE void setRange(int minimum = 0, int maximum = 100);
+  Q_INVOKABLE QString format(const QString& text, const QList<int>& values = QList<int>(),
+                             int base = (1 << 4))const;
+
+  // Nested types
+  Q_INVOKABLE RangeList ranges(Mode mode)const;
+  Q_INVOKABLE const Range& range(int index)const;
+
+  // Not decorated
+  void notInvokable();
+  static Q_INVOKABLE int staticInvokable();
+
+public slots:
+  void reset();
+
+signals:
+  void titleChanged(const QString& title);
+
+protected:
+  Q_INVOKABLE int protectedInvokable();
+  void setCount(int newCount);
+
+private:
+  ctkFixtureMembersPrivate* d_ptr;
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureMultipleBases_h
+#define __ctkFixtureMultipleBases_h
+
+#include "ctkFixtureObject.h"
+
+//-----------------------------------------------------------------------------
+class ctkFixtureMixin
+{
+public:
+  virtual ~ctkFixtureMixin() {}
+};
+
+// Wrapped, derived from a wrapped class and from a class which isn't a
+// QObject. Only analysed, see ctkPythonQtWrapperGeneratorTest1.
+class ctkFixtureMultipleBases : public ctkFixtureObject, public ctkFixtureMixin
+{
+  Q_OBJECT
+public:
+  ctkFixtureMultipleBases(QObject* parent = 0) : ctkFixtureObject(parent) {}
+};
+
+#endif
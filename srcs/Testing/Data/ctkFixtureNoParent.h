@@ -0,0 +1,37 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureNoParent_h
+#define __ctkFixtureNoParent_h
+
+// Qt includes
+#include <QObject>
+
+// Wrapped, without parent: the default constructor is preferred to the one
+// taking a parent
+class ctkFixtureNoParent : public QObject
+{
+  Q_OBJECT
+public:
+  ctkFixtureNoParent() {}
+  explicit ctkFixtureNoParent(QObject* parent) : QObject(parent) {}
+};
+
+#endif
@@ -0,0 +1,45 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureObject_h
+#define __ctkFixtureObject_h
+
+// Qt includes
+#include <QObject>
+
+// Wrapped, with a QObject parent, a property and an invokable method with a
+// default argument
+class ctkFixtureObject : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int value READ value WRITE setValue)
+public:
+  ctkFixtureObject(QObject* parent = 0) : QObject(parent), Value(0) {}
+
+  int value()const { return this->Value; }
+  void setValue(int newValue) { this->Value = newValue; }
+
+  Q_INVOKABLE int add(int a, int b = 1)const { return a + b; }
+
+private:
+  int Value;
+};
+
+#endif
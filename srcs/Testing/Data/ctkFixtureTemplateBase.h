@@ -0,0 +1,43 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureTemplateBase_h
+#define __ctkFixtureTemplateBase_h
+
+#include "ctkFixtureObject.h"
+
+//-----------------------------------------------------------------------------
+template<class T> class ctkFixtureHolder : public T
+{
+public:
+  ctkFixtureHolder(QObject* parent) : T(parent) {}
+};
+
+// Wrapped, derived from a class template instance, which is never a wrapped
+// class. Only analysed, see ctkPythonQtWrapperGeneratorTest1.
+class ctkFixtureTemplateBase : public ctkFixtureHolder< ctkFixtureHolder<ctkFixtureObject> >
+{
+  Q_OBJECT
+public:
+  ctkFixtureTemplateBase(QObject* parent = 0)
+    : ctkFixtureHolder< ctkFixtureHolder<ctkFixtureObject> >(parent) {}
+};
+
+#endif
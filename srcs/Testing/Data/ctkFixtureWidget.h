@@ -0,0 +1,35 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkFixtureWidget_h
+#define __ctkFixtureWidget_h
+
+// Qt includes
+#include <QWidget>
+
+// Wrapped, with a QWidget parent
+class ctkFixtureWidget : public QWidget
+{
+  Q_OBJECT
+public:
+  ctkFixtureWidget(QWidget* parent = 0) : QWidget(parent) {}
+};
+
+#endif
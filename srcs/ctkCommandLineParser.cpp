@@ -27,7 +27,8 @@ public:
       : LongArg(longArg), LongArgPrefix(longArgPrefix),
       ShortArg(shortArg), ShortArgPrefix(shortArgPrefix),
       ArgHelp(argHelp), IgnoreRest(ignoreRest), NumberOfParametersToProcess(0),
-      Deprecated(deprecated), DefaultValue(defaultValue), Value(type), ValueType(type)
+      Deprecated(deprecated), DefaultValue(defaultValue), Value(type), ValueType(type),
+      Index(-1), Slot(-1)
   {
     if (defaultValue.isValid())
       {
@@ -87,8 +88,39 @@ public:
   QVariant       DefaultValue;
   QVariant       Value;
   QVariant::Type ValueType;
+
+  /// Position in ctkCommandLineValues::Present, and in the vector of values
+  /// of its type if the argument was added with addArgument<T>().
+  int            Index;
+  int            Slot;
 };
 
+// --------------------------------------------------------------------------
+// Store the value of a typed argument, or its default constructed value if
+// value is null.
+static void storeTypedValue(ctkCommandLineValues& values,
+                            const CommandLineParserArgumentDescription* desc, const QVariant& value)
+{
+  values.Present[desc->Index] = !value.isNull();
+  switch (desc->ValueType)
+    {
+    case QVariant::Bool:
+      values.Bools[desc->Slot] = value.toBool();
+      break;
+    case QVariant::Int:
+      values.Ints[desc->Slot] = value.toInt();
+      break;
+    case QVariant::String:
+      values.Strings[desc->Slot] = value.toString();
+      break;
+    case QVariant::StringList:
+      values.StringLists[desc->Slot] = value.toStringList();
+      break;
+    default:
+      break;
+    }
+}
+
 // --------------------------------------------------------------------------
 bool CommandLineParserArgumentDescription::addParameter(const QString& value)
 {
@@ -296,6 +328,10 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
       {
       desc->Value = desc->DefaultValue;
       }
+    if (desc->Slot >= 0)
+      {
+      storeTypedValue(this->Values, desc, desc->DefaultValue);
+      }
     }
 
   bool error = false;
@@ -574,6 +610,17 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
     delete settings;
     }
 
+  // Store the typed values where value() reads them
+  foreach (CommandLineParserArgumentDescription* desc,
+           this->Internal->ArgumentDescriptionList)
+    {
+    if (desc->Slot >= 0)
+      {
+      storeTypedValue(this->Values, desc,
+                      parsedArguments.value(desc->LongArg.isEmpty() ? desc->ShortArg : desc->LongArg));
+      }
+    }
+
   return parsedArguments;
 }
 
@@ -655,6 +702,49 @@ void ctkCommandLineParser::addArgument(const QString& longarg, const QString& sh
   this->Internal->GroupToArgumentDescriptionListMap[this->Internal->CurrentGroup] << argDesc;
 }
 
+// --------------------------------------------------------------------------
+int ctkCommandLineParser::addTypedArgument(const QString& longarg, const QString& shortarg,
+                                           QVariant::Type type, const QString& argHelp,
+                                           const QVariant& defaultValue, int* slot)
+{
+  int count = this->Internal->ArgumentDescriptionList.count();
+  this->addArgument(longarg, shortarg, type, argHelp, defaultValue);
+  if (this->Internal->ArgumentDescriptionList.count() == count)
+    {
+    // Not added
+    return -1;
+    }
+
+  CommandLineParserArgumentDescription* argDesc = this->Internal->ArgumentDescriptionList.last();
+  argDesc->Index = count;
+  switch (type)
+    {
+    case QVariant::Bool:
+      argDesc->Slot = this->Values.Bools.size();
+      this->Values.Bools.append(false);
+      break;
+    case QVariant::Int:
+      argDesc->Slot = this->Values.Ints.size();
+      this->Values.Ints.append(0);
+      break;
+    case QVariant::String:
+      argDesc->Slot = this->Values.Strings.size();
+      this->Values.Strings.append(QString());
+      break;
+    case QVariant::StringList:
+      argDesc->Slot = this->Values.StringLists.size();
+      this->Values.StringLists.append(QStringList());
+      break;
+    default:
+      break;
+    }
+  // Present is indexed by argument, typed or not
+  this->Values.Present.resize(count + 1);
+  storeTypedValue(this->Values, argDesc, defaultValue);
+  *slot = argDesc->Slot;
+  return argDesc->Index;
+}
+
 // --------------------------------------------------------------------------
 void ctkCommandLineParser::addDeprecatedArgument(
     const QString& longarg, const QString& shortarg, const QString& argHelp)
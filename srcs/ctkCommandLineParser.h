@@ -5,8 +5,83 @@
 #include <QString>
 #include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 class QSettings;
+class ctkCommandLineParser;
+
+/**
+ * Handle of an argument added with <code>ctkCommandLineParser::addArgument<T>()</code>.
+ *
+ * It locates the value of the argument in the flat storage of the parser,
+ * so that reading it neither hashes the argument name nor converts a
+ * QVariant.
+ */
+template<typename T>
+class ctkCommandLineArgument
+{
+public:
+  ctkCommandLineArgument() : Index(-1), Slot(-1) {}
+
+  /// False if the argument could not be added, e.g. because its name was
+  /// already used.
+  bool isValid()const { return this->Index >= 0; }
+
+private:
+  friend class ctkCommandLineParser;
+  ctkCommandLineArgument(int index, int slot) : Index(index), Slot(slot) {}
+
+  /// Position of the argument among all the added arguments.
+  int Index;
+  /// Position of the value among the values of type T.
+  int Slot;
+};
+
+/**
+ * Values of the typed arguments, stored by type and addressed by the slot
+ * of the argument handle.
+ */
+class ctkCommandLineValues
+{
+public:
+  /// Indexed by argument, true if the argument was supplied on the command
+  /// line or has a default value.
+  QVector<bool>        Present;
+  QVector<bool>        Bools;
+  QVector<int>         Ints;
+  QVector<QString>     Strings;
+  QVector<QStringList> StringLists;
+};
+
+/**
+ * Type of the arguments and storage of their values, for the types
+ * supported by <code>ctkCommandLineParser::addArgument<T>()</code>.
+ */
+template<typename T> struct ctkCommandLineArgumentTraits;
+
+template<> struct ctkCommandLineArgumentTraits<bool>
+{
+  static QVariant::Type type() { return QVariant::Bool; }
+  static QVector<bool> ctkCommandLineValues::* storage() { return &ctkCommandLineValues::Bools; }
+};
+
+template<> struct ctkCommandLineArgumentTraits<int>
+{
+  static QVariant::Type type() { return QVariant::Int; }
+  static QVector<int> ctkCommandLineValues::* storage() { return &ctkCommandLineValues::Ints; }
+};
+
+template<> struct ctkCommandLineArgumentTraits<QString>
+{
+  static QVariant::Type type() { return QVariant::String; }
+  static QVector<QString> ctkCommandLineValues::* storage() { return &ctkCommandLineValues::Strings; }
+};
+
+template<> struct ctkCommandLineArgumentTraits<QStringList>
+{
+  static QVariant::Type type() { return QVariant::StringList; }
+  static QVector<QStringList> ctkCommandLineValues::* storage() { return &ctkCommandLineValues::StringLists; }
+};
 
 // CTK includes
 //#include "ctkCoreExport.h"
@@ -220,6 +295,69 @@ public:
                    const QVariant& defaultValue = QVariant(),
                    bool ignoreRest = false, bool deprecated = false);
 
+  /**
+   * Adds a typed command line argument. <code>T</code> is one of bool, int,
+   * QString or QStringList, matching the QVariant types supported by
+   * <code>addArgument()</code>. Any other type fails to compile.
+   *
+   * The returned handle reads the parsed value with <code>value()</code>:
+   *
+   * \code
+   * ctkCommandLineArgument<int> jobs = parser.addArgument<int>("jobs", "j", "Number of jobs", 1);
+   * parser.parseArguments(QCoreApplication::arguments(), &ok);
+   * int jobCount = parser.value(jobs);
+   * \endcode
+   *
+   * @return An invalid handle if the argument could not be added.
+   * @see addArgument(const QString&, const QString&, QVariant::Type, const QString&, const QVariant&, bool, bool)
+   */
+  template<typename T>
+  ctkCommandLineArgument<T> addArgument(const QString& longarg, const QString& shortarg,
+                                        const QString& argHelp = QString())
+  {
+    int slot = -1;
+    int index = this->addTypedArgument(longarg, shortarg, ctkCommandLineArgumentTraits<T>::type(),
+                                       argHelp, QVariant(), &slot);
+    return ctkCommandLineArgument<T>(index, slot);
+  }
+
+  template<typename T>
+  ctkCommandLineArgument<T> addArgument(const QString& longarg, const QString& shortarg,
+                                        const QString& argHelp, const T& defaultValue)
+  {
+    int slot = -1;
+    int index = this->addTypedArgument(longarg, shortarg, ctkCommandLineArgumentTraits<T>::type(),
+                                       argHelp, QVariant::fromValue(defaultValue), &slot);
+    return ctkCommandLineArgument<T>(index, slot);
+  }
+
+  /**
+   * Value of a typed argument after <code>parseArguments()</code>, the
+   * default constructed value if it was neither supplied nor defaulted, or
+   * if \a argument is invalid.
+   */
+  template<typename T>
+  const T& value(const ctkCommandLineArgument<T>& argument) const
+  {
+    if (!argument.isValid())
+      {
+      static const T defaultValue = T();
+      return defaultValue;
+      }
+    return (this->Values.*ctkCommandLineArgumentTraits<T>::storage()).at(argument.Slot);
+  }
+
+  /**
+   * True if the typed argument was supplied on the command line or has a
+   * default value, i.e. if its key is in the QHash returned by
+   * <code>parseArguments()</code>. False if \a argument is invalid.
+   */
+  template<typename T>
+  bool isSet(const ctkCommandLineArgument<T>& argument) const
+  {
+    return argument.isValid() && this->Values.Present.at(argument.Index);
+  }
+
   /**
    * Adds a deprecated command line argument. If a deprecated argument is provided
    * on the command line, <code>argHelp</code> is displayed in the console and
@@ -370,7 +508,12 @@ public:
   void setStrictModeEnabled(bool strictMode);
 
 private:
+  int addTypedArgument(const QString& longarg, const QString& shortarg,
+                       QVariant::Type type, const QString& argHelp,
+                       const QVariant& defaultValue, int* slot);
+
   class ctkInternal;
   ctkInternal * Internal;
+  ctkCommandLineValues Values;
 };
 #endif
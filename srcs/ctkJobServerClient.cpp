@@ -0,0 +1,233 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkJobServerClient.h"
+
+// STD includes
+#ifndef _WIN32
+# include <errno.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+ctkJobServerClient::ctkJobServerClient()
+{
+  this->ReadFd = -1;
+  this->WriteFd = -1;
+  this->OwnsReadFd = false;
+  this->PollBeforeRead = false;
+}
+
+//-----------------------------------------------------------------------------
+ctkJobServerClient::~ctkJobServerClient()
+{
+  this->disconnect();
+}
+
+//-----------------------------------------------------------------------------
+bool ctkJobServerClient::connectFromEnvironment()
+{
+  return this->connect(QString::fromLocal8Bit(qgetenv("MAKEFLAGS")));
+}
+
+//-----------------------------------------------------------------------------
+bool ctkJobServerClient::connect(const QString& makeFlags)
+{
+  this->disconnect();
+
+#ifdef _WIN32
+  Q_UNUSED(makeFlags);
+  this->ErrorString = "Jobserver is not supported on this platform";
+  return false;
+#else
+  // The last occurrence wins, as with GNU make itself.
+  QString auth;
+  foreach(const QString& flag, makeFlags.split(' ', QString::SkipEmptyParts))
+    {
+    if (flag.startsWith("--jobserver-auth="))
+      {
+      auth = flag.mid(QString("--jobserver-auth=").length());
+      }
+    else if (flag.startsWith("--jobserver-fds="))
+      {
+      auth = flag.mid(QString("--jobserver-fds=").length());
+      }
+    }
+  if (auth.isEmpty())
+    {
+    this->ErrorString = "No jobserver advertised in MAKEFLAGS";
+    return false;
+    }
+
+  if (auth.startsWith("fifo:"))
+    {
+    QByteArray path = QFile::encodeName(auth.mid(5));
+    // Opening our own description of the fifo lets us make it non-blocking
+    // without affecting the other clients.
+    int fd = ::open(path.constData(), O_RDWR | O_NONBLOCK);
+    if (fd < 0)
+      {
+      this->ErrorString = QString("Failed to open jobserver fifo %1").arg(auth.mid(5));
+      return false;
+      }
+    this->ReadFd = fd;
+    this->WriteFd = fd;
+    this->OwnsReadFd = true;
+    return true;
+    }
+
+  QStringList fds = auth.split(',');
+  bool readOk = false;
+  bool writeOk = false;
+  int readFd = fds.value(0).toInt(&readOk);
+  int writeFd = fds.value(1).toInt(&writeOk);
+  if (fds.count() != 2 || !readOk || !writeOk || readFd < 0 || writeFd < 0)
+    {
+    this->ErrorString = QString("Malformed jobserver description [%1]").arg(auth);
+    return false;
+    }
+  // make does not pass the pipe to recipes it does not consider recursive.
+  if (::fcntl(readFd, F_GETFD) == -1 || ::fcntl(writeFd, F_GETFD) == -1)
+    {
+    this->ErrorString = QString("Jobserver file descriptors %1 are not open").arg(auth);
+    return false;
+    }
+
+  // The inherited read end is shared with make and its other children, so it
+  // must not be switched to non-blocking mode. On Linux, re-opening the pipe
+  // through /proc gives a private description; elsewhere poll() before reading.
+  this->ReadFd = -1;
+#ifdef __linux__
+  QByteArray procFd = QString("/proc/self/fd/%1").arg(readFd).toLatin1();
+  this->ReadFd = ::open(procFd.constData(), O_RDONLY | O_NONBLOCK);
+  this->OwnsReadFd = this->ReadFd >= 0;
+#endif
+  if (this->ReadFd < 0)
+    {
+    this->ReadFd = readFd;
+    this->PollBeforeRead = true;
+    }
+  this->WriteFd = writeFd;
+  return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ctkJobServerClient::isConnected()const
+{
+  return this->ReadFd >= 0;
+}
+
+//-----------------------------------------------------------------------------
+int ctkJobServerClient::acquire(int count)
+{
+#ifdef _WIN32
+  Q_UNUSED(count);
+  return 0;
+#else
+  int acquired = 0;
+  while (this->isConnected() && acquired < count)
+    {
+    if (this->PollBeforeRead)
+      {
+      struct pollfd pfd;
+      pfd.fd = this->ReadFd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      if (::poll(&pfd, 1, 0) <= 0 || (pfd.revents & POLLIN) == 0)
+        {
+        break;
+        }
+      }
+    char token = 0;
+    ssize_t n = ::read(this->ReadFd, &token, 1);
+    if (n == 1)
+      {
+      this->Tokens.append(token);
+      ++acquired;
+      continue;
+      }
+    if (n < 0 && errno == EINTR)
+      {
+      continue;
+      }
+    break;
+    }
+  return acquired;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ctkJobServerClient::acquiredCount()const
+{
+  return this->Tokens.size();
+}
+
+//-----------------------------------------------------------------------------
+void ctkJobServerClient::releaseAll()
+{
+#ifndef _WIN32
+  int written = 0;
+  while (written < this->Tokens.size() && this->WriteFd >= 0)
+    {
+    ssize_t n = ::write(this->WriteFd, this->Tokens.constData() + written,
+                        this->Tokens.size() - written);
+    if (n > 0)
+      {
+      written += static_cast<int>(n);
+      }
+    else if (!(n < 0 && errno == EINTR))
+      {
+      this->ErrorString = "Failed to give tokens back to the jobserver";
+      break;
+      }
+    }
+#endif
+  this->Tokens.clear();
+}
+
+//-----------------------------------------------------------------------------
+QString ctkJobServerClient::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+void ctkJobServerClient::disconnect()
+{
+  this->releaseAll();
+#ifndef _WIN32
+  if (this->OwnsReadFd && this->ReadFd >= 0)
+    {
+    ::close(this->ReadFd);
+    }
+#endif
+  this->ReadFd = -1;
+  this->WriteFd = -1;
+  this->OwnsReadFd = false;
+  this->PollBeforeRead = false;
+}
@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkJobServerClient_h
+#define __ctkJobServerClient_h
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Client side of the GNU make jobserver protocol.
+ *
+ * When the generator is started by "make -jN" (or by a tool implementing the
+ * same protocol), MAKEFLAGS advertises a jobserver either as a pair of
+ * inherited pipe file descriptors (--jobserver-auth=R,W or the older
+ * --jobserver-fds=R,W) or as a named pipe (--jobserver-auth=fifo:PATH).
+ * Every process implicitly owns one job slot; additional slots are obtained
+ * by reading one token byte from the jobserver and must be given back by
+ * writing the same byte once the work is done.
+ *
+ * Tokens are never waited for: acquire() only takes the tokens that are
+ * immediately available, so the generator degrades to fewer threads instead
+ * of stalling the build. All acquired tokens are returned on destruction.
+ *
+ * On platforms without POSIX pipes, connectFromEnvironment() always fails.
+ */
+class ctkJobServerClient
+{
+public:
+  ctkJobServerClient();
+  ~ctkJobServerClient();
+
+  /// Connect to the jobserver described by the MAKEFLAGS environment variable.
+  /// Return false if there is none or if it is not usable.
+  bool connectFromEnvironment();
+
+  /// Connect to the jobserver described by \a makeFlags.
+  bool connect(const QString& makeFlags);
+
+  bool isConnected()const;
+
+  /// Try to acquire up to \a count tokens without blocking.
+  /// Return the number of tokens actually acquired.
+  int acquire(int count);
+
+  /// Number of tokens currently held, not counting the implicit one.
+  int acquiredCount()const;
+
+  /// Give back every acquired token to the jobserver.
+  void releaseAll();
+
+  QString errorString()const;
+
+private:
+  void disconnect();
+
+  int        ReadFd;
+  int        WriteFd;
+  bool       OwnsReadFd;
+  bool       PollBeforeRead;
+  QByteArray Tokens;
+  QString    ErrorString;
+};
+
+#endif
@@ -21,6 +21,7 @@
 // Qt includes
 #include <QFile>
 #include <QRegExp>
+#include <QSet>
 #include <QTextStream>
 #include <QFileInfo>
 #include <QDir>
@@ -28,350 +29,1434 @@
 
 // PythonQtWrapper includes
 #include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperAnalysisCache.h"
+#include "ctkPythonQtWrapperDirectoryScanner.h"
+#include "ctkPythonQtWrapperPipeline.h"
+#include "ctkPythonQtWrapperRegistry.h"
 #include "ctkPythonQtWrapperVersion.h"
 
-// STD includes
-#include <iostream>
+namespace
+{
+//-----------------------------------------------------------------------------
+bool readHeader(const QString& filePath, QString& content, QString& errorString)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    errorString = QString("%1 - Failed to open file").arg(filePath);
+    return false;
+    }
+  QTextStream stream(&file);
+  content = stream.readAll();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Collect the analyses streamed by ctkPythonQtWrapperPipeline
+class AnalysisCollector : public ctkPythonQtWrapperPipeline::Consumer
+{
+public:
+  AnalysisCollector(QList<ctkPythonQtWrapperAnalysis>& analyses, bool printRejected,
+                    ctkPythonQtWrapperLogger& logger)
+    : Analyses(analyses), PrintRejected(printRejected), Logger(logger), RejectedCount(0) {}
+
+  virtual void consume(const ctkPythonQtWrapperAnalysis& analysis)
+  {
+    if (!analysis.Valid)
+      {
+      if (this->PrintRejected)
+        {
+        ctkPythonQtWrapperErrorMacro(this->Logger, "error: " + analysis.ErrorString);
+        }
+      this->RejectedCount++;
+      }
+    this->Analyses << analysis;
+  }
+
+  QList<ctkPythonQtWrapperAnalysis>& Analyses;
+  bool PrintRejected;
+  ctkPythonQtWrapperLogger& Logger;
+  int RejectedCount;
+};
+
+//-----------------------------------------------------------------------------
+class AnalysisCacheFiller : public ctkPythonQtWrapperPipeline::Consumer
+{
+public:
+  AnalysisCacheFiller(ctkPythonQtWrapperAnalysisCache* cache, const QString& options,
+                      const QList<ctkPythonQtWrapperAnalysisCache::Stamp>& stamps,
+                      QHash<QString, ctkPythonQtWrapperAnalysis>& analyses)
+    : Cache(cache), Options(options), Stamps(stamps), Analyses(analyses), Index(0) {}
+
+  virtual void consume(const ctkPythonQtWrapperAnalysis& analysis)
+  {
+    this->Cache->insert(analysis.FilePath, this->Stamps.at(this->Index++), this->Options, analysis);
+    this->Analyses.insert(analysis.FilePath, analysis);
+  }
+
+  ctkPythonQtWrapperAnalysisCache* Cache;
+  const QString& Options;
+  const QList<ctkPythonQtWrapperAnalysisCache::Stamp>& Stamps;
+  QHash<QString, ctkPythonQtWrapperAnalysis>& Analyses;
+  int Index;
+};
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapper::ctkPythonQtWrapper()
+  : Logger(stderr)
+{
+  this->RejectionMessagesEnabled = true;
+  this->MaximumThreadCount = 1;
+  this->ProgramName = "PythonQtWrapper";
+  this->ExportMacro = "PythonQtWrapper_INIT_EXPORT";
+  this->PolymorphicHandlersEnabled = false;
+  this->DecoratorsEnabled = false;
+  this->ClangBackendEnabled = false;
+  this->SplitWrappersEnabled = false;
+  this->AnalysisCache = 0;
+  for (int type = 0; type < TemplateCount; ++type)
+    {
+    this->Templates[type].parse(defaultTemplate(static_cast<TemplateType>(type)));
+    }
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapper::~ctkPythonQtWrapper()
+{
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setVerbose(bool value)
+{
+  this->Logger.setLevel(value ? ctkPythonQtWrapperLogger::Debug : ctkPythonQtWrapperLogger::Warning);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::verbose()const
+{
+  return this->Logger.isEnabled(ctkPythonQtWrapperLogger::Debug);
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperLogger& ctkPythonQtWrapper::logger()const
+{
+  return this->Logger;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapper::maximumThreadCount()const
+{
+  return this->MaximumThreadCount;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setMaximumThreadCount(int count)
+{
+  this->MaximumThreadCount = qMax(1, count);
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::lastError()const
+{
+  return this->LastError;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::wrappingNamespace()const
+{
+  return this->WrappingNamespace;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::wrappingNamespaceUnderscore()const
+{
+  QString newWrappingNamespaceUnderscore = this->WrappingNamespace;
+  return newWrappingNamespaceUnderscore.replace(".", "_");
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setWrappingNamespace(const QString& newWrappingNamespace)
+{
+  this->WrappingNamespace = newWrappingNamespace;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::targetName()const
+{
+  return this->TargetName;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setTargetName(const QString& newTargetName)
+{
+  this->TargetName = newTargetName;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::exportMacro()const
+{
+  return this->ExportMacro;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setExportMacro(const QString& newExportMacro)
+{
+  this->ExportMacro = newExportMacro;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::exportHeader()const
+{
+  return this->ExportHeader;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setExportHeader(const QString& newExportHeader)
+{
+  this->ExportHeader = newExportHeader;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::polymorphicHandlersEnabled()const
+{
+  return this->PolymorphicHandlersEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setPolymorphicHandlersEnabled(bool value)
+{
+  this->PolymorphicHandlersEnabled = value;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::decoratorsEnabled()const
+{
+  return this->DecoratorsEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setDecoratorsEnabled(bool value)
+{
+  this->DecoratorsEnabled = value;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::splitWrappersEnabled()const
+{
+  return this->SplitWrappersEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setSplitWrappersEnabled(bool value)
+{
+  this->SplitWrappersEnabled = value;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::clangBackendEnabled()const
+{
+  return this->ClangBackendEnabled;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::setClangBackendEnabled(bool value)
+{
+  if (value && !ctkPythonQtWrapperClangAnalyzer::isAvailable())
+    {
+    this->LastError = "PythonQtWrapper has been built without libclang";
+    return false;
+    }
+  this->ClangBackendEnabled = value;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperClangAnalyzer& ctkPythonQtWrapper::clangAnalyzer()
+{
+  return this->ClangAnalyzer;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysisCache* ctkPythonQtWrapper::analysisCache()const
+{
+  return this->AnalysisCache;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setAnalysisCache(ctkPythonQtWrapperAnalysisCache* cache)
+{
+  this->AnalysisCache = cache;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::analysisOptions()const
+{
+  QString options = QString("decorators=%1 clang=%2").arg(
+        this->DecoratorsEnabled ? 1 : 0).arg(this->ClangBackendEnabled ? 1 : 0);
+  if (this->ClangBackendEnabled)
+    {
+    options += QLatin1Char(' ') + this->ClangAnalyzer.arguments().join(" ");
+    options += QLatin1Char(' ') + this->ClangAnalyzer.preambleHeaders().join(" ");
+    }
+  return options;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::registryFile()const
+{
+  return this->RegistryFile;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setRegistryFile(const QString& newRegistryFile)
+{
+  this->RegistryFile = newRegistryFile;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::updateRegistry()
+{
+  if (this->Analyses.count() != this->PathToExistingCppHeaders.count())
+    {
+    this->validateInputFiles();
+    }
+
+  ctkPythonQtWrapperRegistry registry(this->RegistryFile);
+  if (!registry.open())
+    {
+    this->LastError = registry.errorString();
+    return false;
+    }
+
+  QSet<QString> classNames;
+  QSet<QString> usedClassNames;
+  this->ExternalClasses.clear();
+  this->ReleasedClasses.clear();
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, this->Analyses)
+    {
+    if (!analysis.Valid)
+      {
+      continue;
+      }
+    QString ownerNamespace;
+    QString ownerTarget;
+    if (registry.owner(analysis.ClassName, ownerNamespace, ownerTarget)
+        && (ownerNamespace != this->WrappingNamespace || ownerTarget != this->TargetName))
+      {
+      ctkPythonQtWrapperDebugMacro(this->Logger, QString("external [%1] owned by [%2 %3]").arg(
+                                     analysis.ClassName, ownerNamespace, ownerTarget));
+      this->ExternalClasses.insert(analysis.ClassName, ownerNamespace + ' ' + ownerTarget);
+      registry.addUser(analysis.ClassName, this->WrappingNamespace, this->TargetName);
+      usedClassNames.insert(analysis.ClassName);
+      continue;
+      }
+    registry.setOwner(analysis.ClassName, this->WrappingNamespace, this->TargetName);
+    classNames.insert(analysis.ClassName);
+    }
+  foreach(const QString& className, registry.classes(this->WrappingNamespace, this->TargetName))
+    {
+    if (classNames.contains(className))
+      {
+      continue;
+      }
+    // The users only reference the class, nobody wraps it until they are
+    // generated again
+    QStringList users = registry.users(className);
+    if (!users.isEmpty())
+      {
+      this->ReleasedClasses.insert(className, users);
+      ctkPythonQtWrapperWarningMacro(this->Logger, QString(
+        "%1 - Released by %2 %3 but still listed by %4, which must be generated again "
+        "to wrap it. Make their generation depend on the one of %2 %3.").arg(
+          className, this->WrappingNamespace, this->TargetName, users.join(", ")));
+      }
+    registry.removeOwner(className);
+    }
+  foreach(const QString& className, registry.usedClasses(this->WrappingNamespace, this->TargetName))
+    {
+    if (!usedClassNames.contains(className))
+      {
+      registry.removeUser(className, this->WrappingNamespace, this->TargetName);
+      }
+    }
+
+  if (!registry.close())
+    {
+    this->LastError = registry.errorString();
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+const QHash<QString, QString>& ctkPythonQtWrapper::externalClasses()const
+{
+  return this->ExternalClasses;
+}
+
+//-----------------------------------------------------------------------------
+const QHash<QString, QStringList>& ctkPythonQtWrapper::releasedClasses()const
+{
+  return this->ReleasedClasses;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::setInput(const QStringList& pathToCppHeaders)
+{
+  bool valid = false;
+  foreach(const QString& pathToCppHeader, pathToCppHeaders)
+    {
+    ctkPythonQtWrapperDebugMacro(this->Logger, QString("setInput [%1]").arg(pathToCppHeader));
+    // A missing header stays in the inputs: validateInputFiles() rejects it
+    // as "Failed to open file" and the check report lists it
+    this->PathToExistingCppHeaders << pathToCppHeader;
+    if (!QFile::exists(pathToCppHeader))
+      {
+      this->LastError = QString("%1 - File doesn't exist").arg(pathToCppHeader);
+      ctkPythonQtWrapperWarningMacro(this->Logger, this->LastError);
+      continue;
+      }
+    valid = true;
+    }
+  return valid;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::addInputDirectory(const QString& directory,
+                                           const QStringList& includePatterns,
+                                           const QStringList& excludePatterns)
+{
+  ctkPythonQtWrapperDirectoryScanner scanner;
+  scanner.setThreadCount(this->MaximumThreadCount);
+  scanner.setIncludePatterns(includePatterns);
+  scanner.setExcludePatterns(excludePatterns);
+  QStringList headers;
+  if (!scanner.scan(directory, headers))
+    {
+    this->LastError = scanner.errorString();
+    return false;
+    }
+  foreach(const QString& unreadableDirectory, scanner.unreadableDirectories())
+    {
+    ctkPythonQtWrapperWarningMacro(this->Logger, QString("%1 - Failed to list directory, skipping it")
+                                   .arg(unreadableDirectory));
+    }
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("addInputDirectory [%1] %2 headers").arg(
+                                 directory).arg(headers.count()));
+  // The scanner only returns existing regular headers
+  this->PathToExistingCppHeaders << headers;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+const QStringList& ctkPythonQtWrapper::inputFiles()const
+{
+  return this->PathToExistingCppHeaders;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::addInput(const QString& filePath, const QByteArray& content)
+{
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("addInput [%1]").arg(filePath));
+  this->InputBuffers.insert(filePath, this->decodeInput(content));
+  this->PathToExistingCppHeaders << filePath;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::setOutput(const QString& outputDir)
+{
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("setOutput [%1]").arg(outputDir));
+  this->OutputDir = outputDir;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapper::validateInputFiles()
+{
+  if (this->ClangBackendEnabled && !this->ClangAnalyzer.prepare())
+    {
+    ctkPythonQtWrapperWarningMacro(this->Logger, this->ClangAnalyzer.errorString()
+                                   + " - Parsing the headers without preamble");
+    }
+
+  // The calling thread loads the headers and consumes the results, every
+  // other thread available can analyse headers.
+  ctkPythonQtWrapperPipeline pipeline(this);
+  pipeline.setAnalyserCount(this->MaximumThreadCount - 1);
+
+  this->Analyses.clear();
+  AnalysisCollector collector(this->Analyses, this->RejectionMessagesEnabled, this->Logger);
+  if (!this->AnalysisCache)
+    {
+    pipeline.run(this->PathToExistingCppHeaders, &collector);
+    return collector.RejectedCount;
+    }
+
+  // Only the headers which changed go through the pipeline. In-memory
+  // inputs have no stamp and are always analysed.
+  QString options = this->analysisOptions();
+  QHash<QString, ctkPythonQtWrapperAnalysis> analyses;
+  QStringList changedFiles;
+  QList<ctkPythonQtWrapperAnalysisCache::Stamp> changedStamps;
+  foreach(const QString& filePath, this->PathToExistingCppHeaders)
+    {
+    ctkPythonQtWrapperAnalysisCache::Stamp stamp;
+    if (!this->InputBuffers.contains(filePath))
+      {
+      stamp = ctkPythonQtWrapperAnalysisCache::fileStamp(filePath);
+      }
+    ctkPythonQtWrapperAnalysis analysis;
+    if (this->AnalysisCache->find(filePath, stamp, options, analysis))
+      {
+      analyses.insert(filePath, analysis);
+      }
+    else
+      {
+      changedFiles << filePath;
+      changedStamps << stamp;
+      }
+    }
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("analysis cache [%1 unchanged, %2 changed]")
+                               .arg(this->PathToExistingCppHeaders.count() - changedFiles.count())
+                               .arg(changedFiles.count()));
+  if (!changedFiles.isEmpty())
+    {
+    AnalysisCacheFiller filler(this->AnalysisCache, options, changedStamps, analyses);
+    pipeline.run(changedFiles, &filler);
+    }
+  foreach(const QString& filePath, this->PathToExistingCppHeaders)
+    {
+    collector.consume(analyses.value(filePath));
+    }
+  return collector.RejectedCount;
+}
+
+//-----------------------------------------------------------------------------
+const QList<ctkPythonQtWrapperAnalysis>& ctkPythonQtWrapper::analyses()const
+{
+  return this->Analyses;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::rejectionMessagesEnabled()const
+{
+  return this->RejectionMessagesEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::setRejectionMessagesEnabled(bool value)
+{
+  this->RejectionMessagesEnabled = value;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::writeCheckReport(QIODevice* device)const
+{
+  QTextStream stream(device);
+  stream << "# path\tverdict\tparent\treason\n";
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, this->Analyses)
+    {
+    stream << analysis.FilePath << "\t"
+           << (analysis.Valid ? "accepted" : "rejected") << "\t"
+           << analysis.ParentClassName << "\t"
+           << analysis.Reason << "\n";
+    }
+  stream.flush();
+  return stream.status() == QTextStream::Ok;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::updateAnalysis(const QString& filePath)
+{
+  int index = this->PathToExistingCppHeaders.indexOf(filePath);
+  if (index < 0)
+    {
+    return false;
+    }
+  if (this->Analyses.count() != this->PathToExistingCppHeaders.count())
+    {
+    this->validateInputFiles();
+    return true;
+    }
+  ctkPythonQtWrapperAnalysis analysis = this->analyze(filePath);
+  if (analysis == this->Analyses.at(index))
+    {
+    return false;
+    }
+  this->Analyses[index] = analysis;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::validate(const QString& filePath)
+{
+  ctkPythonQtWrapperAnalysis analysis = this->analyze(filePath);
+  if (!analysis.Valid)
+    {
+    this->LastError = analysis.ErrorString;
+    }
+  return analysis.Valid;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysis ctkPythonQtWrapper::analyze(const QString& filePath)const
+{
+  QString content;
+  QString errorString;
+  if (this->isRegularHeader(filePath) && !this->isPimplHeader(filePath)
+      && !this->readInput(filePath, content, errorString))
+    {
+    ctkPythonQtWrapperAnalysis analysis;
+    analysis.FilePath = filePath;
+    analysis.ClassName = QFileInfo(filePath).completeBaseName();
+    analysis.Reason = "Failed to open file";
+    analysis.ErrorString = errorString;
+    return analysis;
+    }
+  return this->analyze(filePath, content);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::readInput(const QString& filePath, QString& content,
+                                   QString& errorString)const
+{
+  if (this->inputBuffer(filePath, content))
+    {
+    return true;
+    }
+  return readHeader(filePath, content, errorString);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::inputBuffer(const QString& filePath, QString& content)const
+{
+  QHash<QString, QString>::const_iterator buffer = this->InputBuffers.constFind(filePath);
+  if (buffer == this->InputBuffers.constEnd())
+    {
+    return false;
+    }
+  content = buffer.value();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::decodeInput(const QByteArray& buffer)
+{
+  // Same decoding as readHeader()
+  QTextStream stream(buffer, QIODevice::ReadOnly);
+  return stream.readAll();
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysis ctkPythonQtWrapper::analyze(const QString& filePath,
+                                                       const QString& content,
+                                                       int keywordHints)const
+{
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("validate [%1]").arg(filePath));
+
+  ctkPythonQtWrapperAnalysis analysis;
+  analysis.FilePath = filePath;
+  analysis.ClassName = QFileInfo(filePath).completeBaseName();
+
+  if (!this->isRegularHeader(filePath))
+    {
+    analysis.reject("Not a regular header");
+    return analysis;
+    }
+  if (this->isPimplHeader(filePath))
+    {
+    analysis.reject("Pimpl header (*._p.h)");
+    return analysis;
+    }
+
+  if (!(keywordHints & ctkPythonQtWrapperKeywordFilter::QObjectMacro)
+      || !this->hasQObjectMacro(content))
+    {
+    analysis.reject("No Q_OBJECT macro");
+    return analysis;
+    }
+
+  const QString& className = analysis.ClassName;
+  ctkPythonQtWrapperDebugMacro(this->Logger, QString("className [%1]").arg(className));
+
+  if (this->ClangBackendEnabled)
+    {
+    QString errorString;
+    if (this->ClangAnalyzer.analyze(filePath, content, analysis, errorString))
+      {
+      return this->completeAnalysis(analysis, content);
+      }
+    ctkPythonQtWrapperWarningMacro(this->Logger, errorString + " - Falling back to text matching");
+    }
+
+  if (!this->hasValidConstructor(content, className))
+    {
+    analysis.reject("Missing expected constructor signature");
+    return analysis;
+    }
+
+  const int pureVirtualKeywords =
+      ctkPythonQtWrapperKeywordFilter::VirtualKeyword | ctkPythonQtWrapperKeywordFilter::PureSpecifier;
+  if ((keywordHints & pureVirtualKeywords) == pureVirtualKeywords
+      && this->hasVirtualPureMethod(content))
+    {
+    analysis.reject("Contains a virtual pure method");
+    return analysis;
+    }
+
+  if (!this->extractParentClassName(content, className, analysis.ParentClassName))
+    {
+    analysis.reject("Failed to extract parent className");
+    return analysis;
+    }
+
+  this->extractBaseClassName(content, className, analysis.BaseClassName);
+  return this->completeAnalysis(analysis, content);
+}
 
 //-----------------------------------------------------------------------------
-ctkPythonQtWrapper::ctkPythonQtWrapper()
+ctkPythonQtWrapperAnalysis ctkPythonQtWrapper::completeAnalysis(ctkPythonQtWrapperAnalysis analysis,
+                                                                const QString& content)const
 {
-  this->Verbose = false;
-  this->ProgramName = "PythonQtWrapper";
+  if (!analysis.Reason.isEmpty())
+    {
+    return analysis;
+    }
+  if (this->DecoratorsEnabled)
+    {
+    analysis.Members = ctkPythonQtWrapperMembers::extract(content, analysis.ClassName);
+    }
+  analysis.Valid = true;
+  return analysis;
 }
 
 //-----------------------------------------------------------------------------
-ctkPythonQtWrapper::~ctkPythonQtWrapper()
+QString ctkPythonQtWrapper::outputDirectoryName()const
 {
+  return QString("generated_cpp/%1_%2").arg(this->wrappingNamespaceUnderscore(), this->TargetName);
 }
 
 //-----------------------------------------------------------------------------
-void ctkPythonQtWrapper::setVerbose(bool value)
+QString ctkPythonQtWrapper::headerFileName()const
 {
-  this->Verbose = value;
+  return QString("%1_%2").arg(this->wrappingNamespaceUnderscore(), this->TargetName) + "0.h";
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::verbose()const
+QString ctkPythonQtWrapper::initFileName()const
 {
-  return this->Verbose;
+  return QString("%1_%2_init.cpp").arg(this->wrappingNamespaceUnderscore(), this->TargetName);
 }
 
 //-----------------------------------------------------------------------------
-void ctkPythonQtWrapper::displayVerboseMessage(const QString& msg)const
+QMap<QString, QByteArray> ctkPythonQtWrapper::generateOutputBuffers()
 {
-  if (!this->Verbose)
+  if (this->Analyses.count() != this->PathToExistingCppHeaders.count())
     {
-    return;
+    this->validateInputFiles();
     }
-  QTextStream(stdout, QIODevice::WriteOnly) << msg << "\n";
-}
 
-//-----------------------------------------------------------------------------
-QString ctkPythonQtWrapper::wrappingNamespace()const
-{
-  return this->WrappingNamespace;
+  QString wrapWrapIntDir = this->outputDirectoryName();
+  QMap<QString, QByteArray> outputs;
+  outputs.insert(wrapWrapIntDir + "/" + this->headerFileName(),
+                 this->generateHeaderCode().toLocal8Bit());
+  outputs.insert(wrapWrapIntDir + "/" + this->initFileName(),
+                 this->generateInitCode().toLocal8Bit());
+  return outputs;
 }
 
 //-----------------------------------------------------------------------------
-QString ctkPythonQtWrapper::wrappingNamespaceUnderscore()const
+bool ctkPythonQtWrapper::generateOutputs()
 {
-  QString newWrappingNamespaceUnderscore = this->WrappingNamespace;
-  return newWrappingNamespaceUnderscore.replace(".", "_");
+  if (!this->RegistryFile.isEmpty() && !this->updateRegistry())
+    {
+    return false;
+    }
+  return this->writeOutputBuffers(this->generateOutputBuffers());
 }
 
 //-----------------------------------------------------------------------------
-void ctkPythonQtWrapper::setWrappingNamespace(const QString& newWrappingNamespace)
+bool ctkPythonQtWrapper::writeOutputBuffers(const QMap<QString, QByteArray>& outputs)
 {
-  this->WrappingNamespace = newWrappingNamespace;
+  QSet<QString> createdDirs;
+  QMapIterator<QString, QByteArray> it(outputs);
+  while (it.hasNext())
+    {
+    it.next();
+    QString dirPath = QFileInfo(it.key()).path();
+    if (!createdDirs.contains(dirPath))
+      {
+      if (!QDir().mkpath(QString("%1/%2").arg(this->OutputDir).arg(dirPath)))
+        {
+        this->LastError = QString("%1 - Failed to create directory").arg(dirPath);
+        return false;
+        }
+      createdDirs.insert(dirPath);
+      }
+
+    QString filePath = QString("%1/%2").arg(this->OutputDir).arg(it.key());
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly) && file.size() == it.value().size()
+        && file.readAll() == it.value())
+      {
+      ctkPythonQtWrapperDebugMacro(this->Logger, QString("unchanged [%1]").arg(filePath));
+      continue;
+      }
+    file.close();
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(it.value()) != it.value().size())
+      {
+      this->LastError = QString("%1 - Failed to write file").arg(filePath);
+      return false;
+      }
+    }
+  return true;
 }
 
 //-----------------------------------------------------------------------------
-QString ctkPythonQtWrapper::targetName()const
+QString ctkPythonQtWrapper::generateHeaderCode()const
 {
-  return this->TargetName;
+  QString guard = this->wrappingNamespaceUnderscore() + QLatin1Char('_') + this->TargetName
+      + QLatin1String("0_h");
+
+  QString code;
+  code += QLatin1String("//\n// File auto-generated by ");
+  code += this->ProgramName;
+  code += QLatin1String(" " PythonQtWrapper_VERSION "\n//\n\n#ifndef __");
+  code += guard;
+  code += QLatin1String("\n#define __");
+  code += guard;
+  code += QLatin1String("\n");
+  code += headerPrologueCode();
+  code += this->generateHeaderBodyCode();
+  code += QLatin1String("#endif\n");
+  return code;
 }
 
 //-----------------------------------------------------------------------------
-void ctkPythonQtWrapper::setTargetName(const QString& newTargetName)
+QString ctkPythonQtWrapper::headerPrologueCode()
 {
-  this->TargetName = newTargetName;
+  QString code;
+  code += QLatin1String("\n#include <QWidget>\n#include <PythonQt.h>\n\n");
+  code += hiddenMacroDefinition();
+  code += QLatin1Char('\n');
+  code += externTemplateMacroDefinition();
+  code += QLatin1Char('\n');
+  return code;
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::setInput(const QStringList& pathToCppHeaders)
+QString ctkPythonQtWrapper::generateHeaderBodyCode()const
 {
-  bool valid = false;
-  foreach(const QString& pathToCppHeader, pathToCppHeaders)
+  QString values[ctkPythonQtWrapperTemplate::VariableCount];
+  this->initializeTemplateValues(values);
+  QList<ctkPythonQtWrapperAnalysis> analyses = this->generatedAnalyses();
+
+  QString code;
+  code.reserve(512 + analyses.size()
+               * (this->Templates[ClassWrapperWithParentTemplate].literalSize() + 256));
+  if (this->SplitWrappersEnabled)
     {
-    if (!QFile::exists(pathToCppHeader))
+    // Inline decorators need the class definition
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
       {
-      this->LastError = QString("warning: File %1 doesn't exist").arg(pathToCppHeader);
-      std::cerr << qPrintable(this->LastError) << std::endl;
-      break;
+      if (analysis.Members.isEmpty())
+        {
+        code += QLatin1String("class ");
+        code += analysis.ClassName;
+        code += QLatin1String(";\n");
+        }
+      else
+        {
+        code += QLatin1String("#include \"");
+        code += QFileInfo(analysis.FilePath).baseName();
+        code += QLatin1String(".h\"\n");
+        }
       }
-    this->displayVerboseMessage(QString("setInput [%1]").arg(pathToCppHeader));
-    this->PathToExistingCppHeaders << pathToCppHeader;
-    valid = true;
     }
-  return valid;
+  else
+    {
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+      {
+      code += QLatin1String("#include \"");
+      code += QFileInfo(analysis.FilePath).baseName();
+      code += QLatin1String(".h\"\n");
+      }
+    }
+
+  code += QLatin1Char('\n');
+
+  TemplateType withParentTemplate = this->SplitWrappersEnabled ?
+        ClassWrapperDeclarationWithParentTemplate : ClassWrapperWithParentTemplate;
+  TemplateType withoutParentTemplate = this->SplitWrappersEnabled ?
+        ClassWrapperDeclarationWithoutParentTemplate : ClassWrapperWithoutParentTemplate;
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+    {
+    code += QLatin1Char('\n');
+    values[ctkPythonQtWrapperTemplate::ClassName] = analysis.ClassName;
+    values[ctkPythonQtWrapperTemplate::ParentClassName] = analysis.ParentClassName;
+    values[ctkPythonQtWrapperTemplate::Decorators] =
+        analysis.Members.generateDecoratorCode(analysis.ClassName);
+    this->Templates[analysis.ParentClassName.isEmpty() ?
+                    withoutParentTemplate : withParentTemplate].render(values, code);
+    }
+
+  if (!analyses.isEmpty())
+    {
+    // Only instantiated by the init file
+    code += QLatin1String("\n#ifdef PythonQtWrapper_EXTERN_TEMPLATES\n");
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+      {
+      code += QLatin1String("extern template void* PythonQtCreateObject<PythonQtWrapper_");
+      code += analysis.ClassName;
+      code += QLatin1String(">();\n");
+      }
+    code += QLatin1String("#endif\n\n");
+    }
+  return code;
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::setOutput(const QString& outputDir)
+QString ctkPythonQtWrapper::generateInitCode()const
 {
-  this->displayVerboseMessage(QString("setOutput [%1]").arg(outputDir));
-  this->OutputDir = outputDir;
-  return true;
+  QString code;
+  code += QLatin1String("//\n// File auto-generated by ");
+  code += this->ProgramName;
+  code += QLatin1String(" " PythonQtWrapper_VERSION "\n//\n\n#include <PythonQt.h>\n");
+  if (!this->ExportHeader.isEmpty())
+    {
+    code += QLatin1String("#include \"");
+    code += this->ExportHeader;
+    code += QLatin1String("\"\n");
+    }
+  code += QLatin1String("#include \"");
+  code += this->headerFileName();
+  code += QLatin1String("\"\n\n");
+  code += exportMacroDefinition(this->ExportMacro);
+  code += QLatin1Char('\n');
+  code += this->generateInitBodyCode();
+  return code;
 }
 
 //-----------------------------------------------------------------------------
-int ctkPythonQtWrapper::validateInputFiles()
+QString ctkPythonQtWrapper::generateInitBodyCode()const
 {
-  int rejectedCount = 0;
-  foreach(const QString& pathToCppHeader, this->PathToExistingCppHeaders)
+  QString values[ctkPythonQtWrapperTemplate::VariableCount];
+  this->initializeTemplateValues(values);
+  QList<ctkPythonQtWrapperAnalysis> analyses = this->generatedAnalyses();
+  // Scope of the helpers of the target, which may share a translation unit
+  // with other targets, see ctkPythonQtWrapperModule::setUnityBuild()
+  QString helperNamespace = QLatin1String("PythonQtWrapper_")
+      + values[ctkPythonQtWrapperTemplate::WrappingNamespaceUnderscore] + QLatin1Char('_')
+      + values[ctkPythonQtWrapperTemplate::TargetName];
+
+  QString code;
+  code.reserve(512 + analyses.size()
+               * (this->Templates[RegisterClassTemplate].literalSize() + 128));
+  if (this->SplitWrappersEnabled && !analyses.isEmpty())
     {
-    if (!this->validate(pathToCppHeader))
+    // Slots declared by the header
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+      {
+      if (analysis.Members.isEmpty())
+        {
+        code += QLatin1String("#include \"");
+        code += QFileInfo(analysis.FilePath).baseName();
+        code += QLatin1String(".h\"\n");
+        }
+      }
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
       {
-      std::cerr << "error: " << qPrintable(this->LastError) << std::endl;
-      rejectedCount++;
+      code += QLatin1Char('\n');
+      values[ctkPythonQtWrapperTemplate::ClassName] = analysis.ClassName;
+      values[ctkPythonQtWrapperTemplate::ParentClassName] = analysis.ParentClassName;
+      this->Templates[analysis.ParentClassName.isEmpty() ?
+                      ClassWrapperDefinitionWithoutParentTemplate :
+                      ClassWrapperDefinitionWithParentTemplate].render(values, code);
       }
+    code += QLatin1Char('\n');
+    }
+  if (!analyses.isEmpty())
+    {
+    // Declared extern by the header
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+      {
+      code += QLatin1String("template void* PythonQtCreateObject<PythonQtWrapper_");
+      code += analysis.ClassName;
+      code += QLatin1String(">();\n");
+      }
+    code += QLatin1Char('\n');
     }
-  return rejectedCount;
-}
 
-//-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::validate(const QString& filePath)
-{
-  this->displayVerboseMessage(QString("validate [%1]").arg(filePath));
-  if (!this->isRegularHeader(filePath))
+  QStringList polymorphicBaseClassNames;
+  if (this->PolymorphicHandlersEnabled)
     {
-    this->LastError = QString("%1: skipping - Not a regular header").arg(filePath);
-    return false;
+    polymorphicBaseClassNames = this->polymorphicBaseClassNames();
     }
-  if (this->isPimplHeader(filePath))
+  if (!polymorphicBaseClassNames.isEmpty())
     {
-    this->LastError = QString("%1: skipping - Pimpl header (*._p.h)").arg(filePath);
-    return false;
+    code += QLatin1String(
+        "#include <QHash>\n"
+        "\n"
+        "namespace\n"
+        "{\n"
+        "namespace ");
+    code += helperNamespace;
+    code += QLatin1String(
+        "\n"
+        "{\n"
+        "//-----------------------------------------------------------------------------\n"
+        "template<class T> void* PythonQtWrapper_downcast(QObject* object)\n"
+        "{\n"
+        "  return static_cast<T*>(object);\n"
+        "}\n"
+        "\n"
+        "//-----------------------------------------------------------------------------\n"
+        "struct PythonQtWrapper_HierarchyEntry\n"
+        "{\n"
+        "  const QMetaObject* MetaObject;\n"
+        "  const char*        ClassName;\n"
+        "  void*            (*Downcast)(QObject*);\n"
+        "};\n"
+        "\n"
+        "//-----------------------------------------------------------------------------\n"
+        "const PythonQtWrapper_HierarchyEntry PythonQtWrapper_Hierarchy[] =\n"
+        "{\n");
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
+      {
+      values[ctkPythonQtWrapperTemplate::ClassName] = analysis.ClassName;
+      values[ctkPythonQtWrapperTemplate::ParentClassName] = analysis.ParentClassName;
+      this->Templates[HierarchyEntryTemplate].render(values, code);
+      }
+    code += QLatin1String(
+        "};\n"
+        "\n"
+        "// Filled by the init function\n"
+        "QHash<const QMetaObject*, const PythonQtWrapper_HierarchyEntry*> PythonQtWrapper_HierarchyIndex;\n"
+        "\n"
+        "//-----------------------------------------------------------------------------\n"
+        "// Most derived wrapped class of an object returned as a T*, found by\n"
+        "// walking up its meta-objects. Return 0 if it is a T.\n"
+        "template<class T> void* PythonQtWrapper_polymorphicHandler(const void* ptr, const char** className)\n"
+        "{\n"
+        "  QObject* object = const_cast<T*>(static_cast<const T*>(ptr));\n"
+        "  for (const QMetaObject* metaObject = object->metaObject();\n"
+        "       metaObject && metaObject != &T::staticMetaObject;\n"
+        "       metaObject = metaObject->superClass())\n"
+        "    {\n"
+        "    const PythonQtWrapper_HierarchyEntry* entry =\n"
+        "        PythonQtWrapper_HierarchyIndex.value(metaObject);\n"
+        "    if (entry)\n"
+        "      {\n"
+        "      *className = entry->ClassName;\n"
+        "      return entry->Downcast(object);\n"
+        "      }\n"
+        "    }\n"
+        "  return 0;\n"
+        "}\n"
+        "}\n"
+        "}\n"
+        "\n");
     }
 
-  if (!this->hasQObjectMacro(filePath))
+  code += this->ExportMacro;
+  code += QLatin1String(" void PythonQt_init_");
+  code += values[ctkPythonQtWrapperTemplate::WrappingNamespaceUnderscore];
+  code += QLatin1Char('_');
+  code += values[ctkPythonQtWrapperTemplate::TargetName];
+  code += QLatin1String("(PyObject* module)\n{\n  Q_UNUSED(module);\n");
+  if (!polymorphicBaseClassNames.isEmpty())
     {
-    this->LastError = QString("%1: skipping - No Q_OBJECT macro").arg(filePath);
-    return false;
+    code += QLatin1String("  using namespace ");
+    code += helperNamespace;
+    code += QLatin1String(";\n");
     }
 
-  QFileInfo fileinfo(filePath);
-  QString className = fileinfo.completeBaseName();
-  this->displayVerboseMessage(QString("className [%1]").arg(className));
-
-  if (!this->hasValidConstructor(filePath, className))
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
     {
-    this->LastError = QString("%1: skipping - Missing expected constructor signature").arg(filePath);
-    return false;
+    code += QLatin1Char('\n');
+    values[ctkPythonQtWrapperTemplate::ClassName] = analysis.ClassName;
+    values[ctkPythonQtWrapperTemplate::ParentClassName] = analysis.ParentClassName;
+    this->Templates[RegisterClassTemplate].render(values, code);
     }
 
-  if (this->hasVirtualPureMethod(filePath))
+  QHashIterator<QString, QString> external(this->ExternalClasses);
+  while (external.hasNext())
     {
-    this->LastError = QString("%1: skipping - Contains a virtual pure method").arg(filePath);
-    return false;
+    external.next();
+    code += QLatin1String("\n  // ");
+    code += external.key();
+    code += QLatin1String(" is wrapped and registered by ");
+    code += external.value();
+    code += QLatin1Char('\n');
     }
 
-  QString parentClassName;
-  if (!this->extractParentClassName(filePath, className, parentClassName))
+  if (!polymorphicBaseClassNames.isEmpty())
     {
-    this->LastError = QString("%1: skipping - Failed to extract parent className").arg(filePath);
-    return false;
+    code += QLatin1String(
+        "\n"
+        "  for (unsigned int i = 0;\n"
+        "       i < sizeof(PythonQtWrapper_Hierarchy) / sizeof(PythonQtWrapper_Hierarchy[0]); ++i)\n"
+        "    {\n"
+        "    PythonQtWrapper_HierarchyIndex.insert(PythonQtWrapper_Hierarchy[i].MetaObject,\n"
+        "                                          &PythonQtWrapper_Hierarchy[i]);\n"
+        "    }\n");
+    values[ctkPythonQtWrapperTemplate::ParentClassName].clear();
+    foreach(const QString& className, polymorphicBaseClassNames)
+      {
+      values[ctkPythonQtWrapperTemplate::ClassName] = className;
+      this->Templates[PolymorphicHandlerTemplate].render(values, code);
+      }
     }
 
-  return true;
+  code += QLatin1String("}\n");
+  return code;
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::generateOutputs()
+QList<ctkPythonQtWrapperAnalysis> ctkPythonQtWrapper::generatedAnalyses()const
 {
-  QString target = this->targetName();
-  QString wrapWrapIntDir =
-      QString("generated_cpp/%1_%2").arg(this->wrappingNamespaceUnderscore(), target);
-
-  if (!QDir().mkpath(QString("%1/%2").arg(this->OutputDir).arg(wrapWrapIntDir)))
+  QList<ctkPythonQtWrapperAnalysis> analyses;
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, this->Analyses)
     {
-    this->LastError = QString("%1 - Failed to create directory").arg(wrapWrapIntDir);
-    return false;
+    if (analysis.Valid && !this->ExternalClasses.contains(analysis.ClassName))
+      {
+      analyses << analysis;
+      }
     }
+  return analyses;
+}
 
-  // Header file
-  QString headerFilePath =
-      wrapWrapIntDir + "/" +
-      this->wrappingNamespaceUnderscore() + "_" + target + "0.h";
-  QFile headerFile(headerFilePath);
-  if (!headerFile.open(QIODevice::WriteOnly))
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapper::polymorphicBaseClassNames()const
+{
+  QList<ctkPythonQtWrapperAnalysis> analyses = this->generatedAnalyses();
+  QSet<QString> classNames;
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
     {
-    this->LastError = QString("%1 - Failed to open file").arg(headerFilePath);
-    return false;
+    classNames.insert(analysis.ClassName);
     }
-
-  QTextStream headerStream(&headerFile);
-  headerStream << "//\n"
-      << "// File auto-generated by " << this->ProgramName << " " << PythonQtWrapper_VERSION << "\n"
-      << "//\n"
-      << "\n"
-      << "#ifndef __" << this->wrappingNamespaceUnderscore() << "_" << target << "0_h\n"
-      << "#define __" << this->wrappingNamespaceUnderscore() << "_" << target << "0_h\n"
-      << "\n"
-      << "#include <QWidget>\n";
-
-  foreach(const QString& pathToHeader, this->PathToExistingCppHeaders)
+  QSet<QString> baseClassNames;
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
     {
-    headerStream << "#include \"" << QFileInfo(pathToHeader).baseName() << ".h\"\n";
+    if (classNames.contains(analysis.BaseClassName))
+      {
+      baseClassNames.insert(analysis.BaseClassName);
+      }
     }
-
-  headerStream << "\n";
-
-  foreach(const QString& pathToHeader, this->PathToExistingCppHeaders)
+  QStringList names;
+  foreach(const ctkPythonQtWrapperAnalysis& analysis, analyses)
     {
-    QString className = QFileInfo(pathToHeader).completeBaseName();
-    QString parentClassName;
-    this->extractParentClassName(pathToHeader, className, parentClassName);
-    headerStream << "\n";
-    headerStream << generateClassWrapperCode(className, parentClassName);
+    if (baseClassNames.remove(analysis.ClassName))
+      {
+      names << analysis.ClassName;
+      }
     }
+  return names;
+}
 
-  headerStream << "#endif\n";
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::generateClassWrapperCode(const QString& className,
+                                                     const QString& parentClassName)const
+{
+  QString values[ctkPythonQtWrapperTemplate::VariableCount];
+  this->initializeTemplateValues(values);
+  values[ctkPythonQtWrapperTemplate::ClassName] = className;
+  values[ctkPythonQtWrapperTemplate::ParentClassName] = parentClassName;
+  QString code;
+  this->Templates[parentClassName.isEmpty() ?
+                  ClassWrapperWithoutParentTemplate : ClassWrapperWithParentTemplate]
+      .render(values, code);
+  return code;
+}
 
-  // Init Cpp file
-  QString initFilePath =
-      QString("%1/%2_%3_init.cpp").arg(wrapWrapIntDir).arg(this->wrappingNamespaceUnderscore()).arg(target);
-  QFile initFile(initFilePath);
-  if (!initFile.open(QIODevice::WriteOnly))
-    {
-    this->LastError = QString("%1 - Failed to open file").arg(initFilePath);
-    return false;
-    }
-  QTextStream initStream(&initFile);
-  initStream << "//\n"
-      << "// File auto-generated by " << this->ProgramName << " " << PythonQtWrapper_VERSION << "\n"
-      << "//\n"
-      << "\n"
-      << "#include <PythonQt.h>\n"
-      << "#include \"" << this->wrappingNamespaceUnderscore() << "_" << target << "0.h\"\n"
-      << "\n"
-      << "void PythonQt_init_" << this->wrappingNamespaceUnderscore()
-                               << "_" << target << "(PyObject* module)\n"
-      << "{\n"
-      << "  Q_UNUSED(module);\n";
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::generateClassWrapperDefinitionCode(const QString& className,
+                                                               const QString& parentClassName)const
+{
+  QString values[ctkPythonQtWrapperTemplate::VariableCount];
+  this->initializeTemplateValues(values);
+  values[ctkPythonQtWrapperTemplate::ClassName] = className;
+  values[ctkPythonQtWrapperTemplate::ParentClassName] = parentClassName;
+  QString code;
+  this->Templates[parentClassName.isEmpty() ?
+                  ClassWrapperDefinitionWithoutParentTemplate :
+                  ClassWrapperDefinitionWithParentTemplate].render(values, code);
+  return code;
+}
 
-  foreach(const QString& pathToHeader, this->PathToExistingCppHeaders)
-    {
-    QString className = QFileInfo(pathToHeader).completeBaseName();
-    initStream << "\n";
-    initStream << this->generateRegisterClassCode(className, this->TargetName);
-    }
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::generateRegisterClassCode(const QString& className,
+                                                      const QString& targetName)const
+{
+  QString values[ctkPythonQtWrapperTemplate::VariableCount];
+  this->initializeTemplateValues(values);
+  values[ctkPythonQtWrapperTemplate::ClassName] = className;
+  values[ctkPythonQtWrapperTemplate::TargetName] = targetName;
+  QString code;
+  this->Templates[RegisterClassTemplate].render(values, code);
+  return code;
+}
 
-  initStream << "}\n";
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::hiddenMacroDefinition()
+{
+  return QLatin1String(
+      "#ifndef PythonQtWrapper_HIDDEN\n"
+      "# if defined(__GNUC__) && __GNUC__ >= 4\n"
+      "#  define PythonQtWrapper_HIDDEN __attribute__((visibility(\"hidden\")))\n"
+      "# else\n"
+      "#  define PythonQtWrapper_HIDDEN\n"
+      "# endif\n"
+      "#endif\n");
+}
 
-  return true;
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::externTemplateMacroDefinition()
+{
+  // extern template is C++11, but older GNU and Microsoft compilers support
+  // it as an extension
+  return QLatin1String(
+      "#if !defined(PythonQtWrapper_EXTERN_TEMPLATES) && !defined(PythonQtWrapper_NO_EXTERN_TEMPLATES)\n"
+      "# if __cplusplus >= 201103L || defined(_MSC_VER) \\\n"
+      "  || (defined(__GNUC__) && !defined(__STRICT_ANSI__))\n"
+      "#  define PythonQtWrapper_EXTERN_TEMPLATES\n"
+      "# endif\n"
+      "#endif\n");
 }
 
 //-----------------------------------------------------------------------------
-QString ctkPythonQtWrapper::generateClassWrapperCode(const QString& className,
-                                                     const QString& parentClassName)
+QString ctkPythonQtWrapper::exportMacroDefinition(const QString& exportMacro)
+{
+  QString code;
+  code += QLatin1String("#ifndef ");
+  code += exportMacro;
+  code += QLatin1String("\n# if defined(_WIN32)\n#  define ");
+  code += exportMacro;
+  code += QLatin1String(" __declspec(dllexport)\n"
+                        "# elif defined(__GNUC__) && __GNUC__ >= 4\n#  define ");
+  code += exportMacro;
+  code += QLatin1String(" __attribute__((visibility(\"default\")))\n# else\n#  define ");
+  code += exportMacro;
+  code += QLatin1String("\n# endif\n#endif\n");
+  return code;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapper::initializeTemplateValues(QString* values)const
+{
+  values[ctkPythonQtWrapperTemplate::TargetName] = this->TargetName;
+  values[ctkPythonQtWrapperTemplate::WrappingNamespace] = this->WrappingNamespace;
+  values[ctkPythonQtWrapperTemplate::WrappingNamespaceUnderscore] =
+      this->wrappingNamespaceUnderscore();
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::templateFileName(TemplateType type)
 {
-  if (!parentClassName.isEmpty())
+  switch (type)
     {
-    QString wrappedClassWithParent =
+    case ClassWrapperWithParentTemplate:
+      return "ClassWrapperWithParent.in";
+    case ClassWrapperWithoutParentTemplate:
+      return "ClassWrapperWithoutParent.in";
+    case RegisterClassTemplate:
+      return "RegisterClass.in";
+    case HierarchyEntryTemplate:
+      return "HierarchyEntry.in";
+    case PolymorphicHandlerTemplate:
+      return "PolymorphicHandler.in";
+    case ClassWrapperDeclarationWithParentTemplate:
+      return "ClassWrapperDeclarationWithParent.in";
+    case ClassWrapperDeclarationWithoutParentTemplate:
+      return "ClassWrapperDeclarationWithoutParent.in";
+    case ClassWrapperDefinitionWithParentTemplate:
+      return "ClassWrapperDefinitionWithParent.in";
+    case ClassWrapperDefinitionWithoutParentTemplate:
+      return "ClassWrapperDefinitionWithoutParent.in";
+    default:
+      return QString();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapper::defaultTemplate(TemplateType type)
+{
+  switch (type)
+    {
+    case ClassWrapperWithParentTemplate:
+      return
         "//-----------------------------------------------------------------------------\n"
-        "class PythonQtWrapper_%1 : public QObject\n"
+        "class PythonQtWrapper_HIDDEN PythonQtWrapper_@ClassName@ : public QObject\n"
         "{\n"
         "  Q_OBJECT\n"
         "public:\n"
         "public slots:\n"
-        "  %1* new_%1(%2*  parent = 0)\n"
+        "  @ClassName@* new_@ClassName@(@ParentClassName@*  parent = 0)\n"
         "    {\n"
-        "    return new %1(parent);\n"
+        "    return new @ClassName@(parent);\n"
         "    }\n"
-        "  void delete_%1(%1* obj) { delete obj; }\n"
+        "  void delete_@ClassName@(@ClassName@* obj) { delete obj; }\n"
+        "@Decorators@"
         "};\n";
-    return wrappedClassWithParent.arg(className).arg(parentClassName);
-    }
-  else
-    {
-    QString wrappedClassWithoutParent =
+    case ClassWrapperWithoutParentTemplate:
+      return
         "//-----------------------------------------------------------------------------\n"
-        "class PythonQtWrapper_%1 : public QObject\n"
+        "class PythonQtWrapper_HIDDEN PythonQtWrapper_@ClassName@ : public QObject\n"
         "{\n"
         "  Q_OBJECT\n"
         "public:\n"
         "public slots:\n"
-        "  %1* new_%1()\n"
+        "  @ClassName@* new_@ClassName@()\n"
         "    {\n"
-        "    return new %1();\n"
+        "    return new @ClassName@();\n"
         "    }\n"
-        "  void delete_%1(%1* obj) { delete obj; }\n"
+        "  void delete_@ClassName@(@ClassName@* obj) { delete obj; }\n"
+        "@Decorators@"
+        "};\n";
+    case RegisterClassTemplate:
+      return
+        "  PythonQt::self()->registerClass(\n"
+        "    &@ClassName@::staticMetaObject, \"@TargetName@\",\n"
+        "    PythonQtCreateObject<PythonQtWrapper_@ClassName@>);\n";
+    case HierarchyEntryTemplate:
+      return
+        "  { &@ClassName@::staticMetaObject, \"@ClassName@\",\n"
+        "    PythonQtWrapper_downcast<@ClassName@> },\n";
+    case PolymorphicHandlerTemplate:
+      return
+        "  PythonQt::self()->addPolymorphicHandler(\n"
+        "    \"@ClassName@\", PythonQtWrapper_polymorphicHandler<@ClassName@>);\n";
+    case ClassWrapperDeclarationWithParentTemplate:
+      return
+        "//-----------------------------------------------------------------------------\n"
+        "class PythonQtWrapper_HIDDEN PythonQtWrapper_@ClassName@ : public QObject\n"
+        "{\n"
+        "  Q_OBJECT\n"
+        "public:\n"
+        "public slots:\n"
+        "  @ClassName@* new_@ClassName@(@ParentClassName@*  parent = 0);\n"
+        "  void delete_@ClassName@(@ClassName@* obj);\n"
+        "@Decorators@"
+        "};\n";
+    case ClassWrapperDeclarationWithoutParentTemplate:
+      return
+        "//-----------------------------------------------------------------------------\n"
+        "class PythonQtWrapper_HIDDEN PythonQtWrapper_@ClassName@ : public QObject\n"
+        "{\n"
+        "  Q_OBJECT\n"
+        "public:\n"
+        "public slots:\n"
+        "  @ClassName@* new_@ClassName@();\n"
+        "  void delete_@ClassName@(@ClassName@* obj);\n"
+        "@Decorators@"
         "};\n";
-    return wrappedClassWithoutParent.arg(className).arg(parentClassName);
+    case ClassWrapperDefinitionWithParentTemplate:
+      return
+        "//-----------------------------------------------------------------------------\n"
+        "@ClassName@* PythonQtWrapper_@ClassName@::new_@ClassName@(@ParentClassName@* parent)\n"
+        "{\n"
+        "  return new @ClassName@(parent);\n"
+        "}\n"
+        "\n"
+        "//-----------------------------------------------------------------------------\n"
+        "void PythonQtWrapper_@ClassName@::delete_@ClassName@(@ClassName@* obj)\n"
+        "{\n"
+        "  delete obj;\n"
+        "}\n";
+    case ClassWrapperDefinitionWithoutParentTemplate:
+      return
+        "//-----------------------------------------------------------------------------\n"
+        "@ClassName@* PythonQtWrapper_@ClassName@::new_@ClassName@()\n"
+        "{\n"
+        "  return new @ClassName@();\n"
+        "}\n"
+        "\n"
+        "//-----------------------------------------------------------------------------\n"
+        "void PythonQtWrapper_@ClassName@::delete_@ClassName@(@ClassName@* obj)\n"
+        "{\n"
+        "  delete obj;\n"
+        "}\n";
+    default:
+      return QString();
     }
 }
 
 //-----------------------------------------------------------------------------
-QString ctkPythonQtWrapper::generateRegisterClassCode(const QString& className,
-                                                      const QString& targetName)
+bool ctkPythonQtWrapper::setTemplate(TemplateType type, const QString& text)
 {
-  QString registerClass =
-      "  PythonQt::self()->registerClass(\n"
-      "    &%1::staticMetaObject, \"%2\",\n"
-      "    PythonQtCreateObject<PythonQtWrapper_%1>);\n";
+  if (type < 0 || type >= TemplateCount)
+    {
+    return false;
+    }
+  ctkPythonQtWrapperTemplate parsedTemplate;
+  if (!parsedTemplate.parse(text))
+    {
+    this->LastError = QString("%1 template - %2").arg(
+          templateFileName(type), parsedTemplate.errorString());
+    return false;
+    }
+  this->Templates[type] = parsedTemplate;
+  return true;
+}
 
-  return registerClass.arg(className, targetName);
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::loadTemplates(const QString& directory)
+{
+  QDir dir(directory);
+  if (!dir.exists())
+    {
+    this->LastError = QString("%1 - Template directory doesn't exist").arg(directory);
+    return false;
+    }
+  for (int type = 0; type < TemplateCount; ++type)
+    {
+    QString filePath = dir.filePath(templateFileName(static_cast<TemplateType>(type)));
+    if (!QFile::exists(filePath))
+      {
+      continue;
+      }
+    QString text;
+    QString errorString;
+    if (!readHeader(filePath, text, errorString))
+      {
+      this->LastError = errorString;
+      return false;
+      }
+    if (!this->setTemplate(static_cast<TemplateType>(type), text))
+      {
+      this->LastError = QString("%1 - %2").arg(filePath, this->LastError);
+      return false;
+      }
+    ctkPythonQtWrapperDebugMacro(this->Logger, QString("template [%1]").arg(filePath));
+    }
+  return true;
 }
 
 //-----------------------------------------------------------------------------
 bool ctkPythonQtWrapper::isRegularHeader(const QString& filePath)
 {
-  QRegExp re("^.*\\.h$", Qt::CaseInsensitive);
-  return re.exactMatch(filePath);
+  // Called for every file found by ctkPythonQtWrapperDirectoryScanner
+  return filePath.endsWith(QLatin1String(".h"), Qt::CaseInsensitive);
 }
 
 //-----------------------------------------------------------------------------
 bool ctkPythonQtWrapper::isPimplHeader(const QString& filePath)
 {
-  QRegExp re("^.*_p\\.h", Qt::CaseInsensitive);
-  return re.exactMatch(filePath);
+  return filePath.endsWith(QLatin1String("_p.h"), Qt::CaseInsensitive);
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::hasQObjectMacro(const QString& filePath)
+bool ctkPythonQtWrapper::hasQObjectMacro(const QString& content)
 {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly))
-    {
-    this->LastError = QString("%1 - Failed to open file").arg(filePath);
-    return false;
-    }
-  QTextStream stream(&file);
-  while (!stream.atEnd())
-    {
-    QString line = stream.readLine();
-    if (line.contains("Q_OBJECT"))
-      {
-      return true;
-      }
-    }
-  return false;
+  return content.contains("Q_OBJECT");
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::hasValidConstructor(const QString& filePath,
+bool ctkPythonQtWrapper::hasValidConstructor(const QString& content,
                                              const QString& className)
 {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly))
-    {
-    this->LastError = QString("%1 - Failed to open file").arg(filePath);
-    return false;
-    }
-  QTextStream stream(&file);
-  QString content = stream.readAll();
   QString reStr = QString(
       "[^~]%1[\\s\\n]*\\([\\s\\n]*((QObject|QWidget)[\\s\\n]*\\*[\\s\\n]*\\w+[\\s\\n]*(\\=[\\s\\n]*(0|NULL)|,.*\\=.*\\)|\\)|\\)))").arg(className);
   QRegExp re(reStr);
@@ -379,34 +1464,17 @@ bool ctkPythonQtWrapper::hasValidConstructor(const QString& filePath,
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::hasVirtualPureMethod(const QString& filePath)
+bool ctkPythonQtWrapper::hasVirtualPureMethod(const QString& content)
 {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly))
-    {
-    this->LastError = QString("%1 - Failed to open file").arg(filePath);
-    return false;
-    }
-  QTextStream stream(&file);
-  QString content = stream.readAll();
   QRegExp re("virtual[\\w\\n\\s\\*\\(\\)]+\\=[\\s\\n]*(0|NULL)[\\s\\n]*;");
   return re.indexIn(content) >= 0;
 }
 
 //-----------------------------------------------------------------------------
-bool ctkPythonQtWrapper::extractParentClassName(const QString& filePath,
-                                                   const QString& className,
-                                                   QString& parentClassName)
+bool ctkPythonQtWrapper::extractParentClassName(const QString& content,
+                                                const QString& className,
+                                                QString& parentClassName)
 {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly))
-    {
-    this->LastError = QString("%1 - Failed to open file").arg(filePath);
-    return false;
-    }
-  QTextStream stream(&file);
-  QString content = stream.readAll();
-
   parentClassName.clear();
 
   QRegExp reNoParent(QString("[^~]%1[\\s\\n]*\\([\\s\\n]*\\)").arg(className));
@@ -432,6 +1500,45 @@ bool ctkPythonQtWrapper::extractParentClassName(const QString& filePath,
   return false;
 }
 
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapper::extractBaseClassName(const QString& content,
+                                              const QString& className,
+                                              QString& baseClassName)
+{
+  baseClassName.clear();
 
+  // The class may be declared with an export macro, and the base class
+  // specifier may be virtual
+  QRegExp reBaseClass(QString("class[\\s\\n]+(\\w+[\\s\\n]+)?%1[\\s\\n]*:[\\s\\n]*"
+                              "((public|protected|private|virtual)[\\s\\n]+)*([\\w:]+)").arg(className));
+  if (reBaseClass.indexIn(content) < 0)
+    {
+    return false;
+    }
+  baseClassName = reBaseClass.cap(4);
 
-
+  // Keep the arguments of a template base class, which is never a wrapped
+  // class
+  int position = reBaseClass.pos(4) + baseClassName.length();
+  while (position < content.length() && content.at(position).isSpace())
+    {
+    ++position;
+    }
+  if (position < content.length() && content.at(position) == QLatin1Char('<'))
+    {
+    int depth = 0;
+    for (int end = position; end < content.length(); ++end)
+      {
+      if (content.at(end) == QLatin1Char('<'))
+        {
+        ++depth;
+        }
+      else if (content.at(end) == QLatin1Char('>') && --depth == 0)
+        {
+        baseClassName += content.mid(position, end - position + 1).simplified();
+        break;
+        }
+      }
+    }
+  return true;
+}
@@ -22,17 +22,122 @@
 #define __ctkPythonQtWrapper_h
 
 // Qt includes
+#include <QByteArray>
+#include <QIODevice>
+#include <QHash>
+#include <QList>
+#include <QMap>
 #include <QStringList>
 
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperClangAnalyzer.h"
+#include "ctkPythonQtWrapperKeywordFilter.h"
+#include "ctkPythonQtWrapperLogger.h"
+#include "ctkPythonQtWrapperMembers.h"
+#include "ctkPythonQtWrapperTemplate.h"
+
+class ctkPythonQtWrapperAnalysisCache;
+
+/**
+ * Outcome of the analysis of a single header.
+ *
+ * Instances are plain values: they are returned by
+ * ctkPythonQtWrapper::analyze() and never refer back to the wrapper,
+ * so they can be produced and consumed from any thread.
+ */
+class ctkPythonQtWrapperAnalysis
+{
+public:
+  ctkPythonQtWrapperAnalysis() : Valid(false) {}
+
+  bool operator==(const ctkPythonQtWrapperAnalysis& other)const
+  {
+    return this->FilePath == other.FilePath
+        && this->ClassName == other.ClassName
+        && this->ParentClassName == other.ParentClassName
+        && this->BaseClassName == other.BaseClassName
+        && this->Members == other.Members
+        && this->Valid == other.Valid
+        && this->Reason == other.Reason
+        && this->ErrorString == other.ErrorString;
+  }
+  bool operator!=(const ctkPythonQtWrapperAnalysis& other)const
+  {
+    return !(*this == other);
+  }
+
+  /// Mark the header as rejected because of \a reason.
+  void reject(const QString& reason)
+  {
+    this->Valid = false;
+    this->Reason = reason;
+    this->ErrorString = QString("%1: skipping - %2").arg(this->FilePath, reason);
+  }
+
+  QString FilePath;
+  QString ClassName;
+  QString ParentClassName;
+  /// First base class of the class, with its template arguments if any,
+  /// empty if it couldn't be extracted.
+  QString BaseClassName;
+  /// Members decorated by the wrapper, empty unless decorators are enabled.
+  ctkPythonQtWrapperMembers Members;
+  /// True if the header can be wrapped.
+  bool    Valid;
+  /// Reason why the header has been rejected, empty if valid.
+  QString Reason;
+  /// Diagnostic message including the file path, empty if valid.
+  QString ErrorString;
+};
+
+/**
+ * Generate PythonQt wrappers for QObject based classes.
+ *
+ * Inputs can either be header files or in-memory buffers (see addInput()),
+ * and the generated sources can either be written below the output
+ * directory (generateOutputs()) or returned as buffers
+ * (generateOutputBuffers()). The in-memory path performs no file I/O, which
+ * allows tools linking against the ctkPythonQtWrapperCore library to
+ * generate wrappers in-process.
+ */
 class ctkPythonQtWrapper
 {
 public:
+  /// Templates used to generate the per-class code, see
+  /// ctkPythonQtWrapperTemplate for their syntax.
+  enum TemplateType
+    {
+    ClassWrapperWithParentTemplate = 0,
+    ClassWrapperWithoutParentTemplate,
+    RegisterClassTemplate,
+    HierarchyEntryTemplate,
+    PolymorphicHandlerTemplate,
+    ClassWrapperDeclarationWithParentTemplate,
+    ClassWrapperDeclarationWithoutParentTemplate,
+    ClassWrapperDefinitionWithParentTemplate,
+    ClassWrapperDefinitionWithoutParentTemplate,
+    TemplateCount
+    };
+
   ctkPythonQtWrapper();
   ~ctkPythonQtWrapper();
 
+  /// Shortcut for setting the logger level to Debug (or back to Warning).
   void setVerbose(bool value);
   bool verbose()const;
-  void displayVerboseMessage(const QString& msg)const;
+
+  /// Sink of the progress, warning and error messages, written to stderr.
+  /// It is thread-safe, and can be used from const methods.
+  ctkPythonQtWrapperLogger& logger()const;
+
+  /// Upper bound on the number of threads the generator may use, including
+  /// the calling one. Defaults to 1.
+  int maximumThreadCount()const;
+  void setMaximumThreadCount(int count);
+
+  /// Description of the last failure of setInput(), validate() or
+  /// generateOutputs().
+  QString lastError()const;
 
   QString wrappingNamespace()const;
   QString wrappingNamespaceUnderscore()const;
@@ -41,38 +146,276 @@ public:
   QString targetName()const;
   void setTargetName(const QString& newTargetName);
 
+  /// Macro giving the init function its visibility, defaults to
+  /// PythonQtWrapper_INIT_EXPORT. Unless already defined, e.g. by the header
+  /// set with setExportHeader(), the generated init file defines it to
+  /// export the function. The wrapper classes are declared with
+  /// PythonQtWrapper_HIDDEN, so that the init function is the only symbol
+  /// exported by a wrapper library.
+  QString exportMacro()const;
+  void setExportMacro(const QString& newExportMacro);
+
+  /// Header included by the init file before the export macro is used.
+  QString exportHeader()const;
+  void setExportHeader(const QString& newExportHeader);
+
+  /// If enabled, the init file registers a polymorphic handler for every
+  /// class which is the base class of another class of the target. The
+  /// handlers map an object returned as a pointer to its base class to its
+  /// most derived wrapped class by looking up its meta-object in a table of
+  /// the wrapped classes, instead of letting PythonQt compare class names.
+  /// Disabled by default.
+  bool polymorphicHandlersEnabled()const;
+  void setPolymorphicHandlersEnabled(bool value);
+
+  /// If enabled, the Q_PROPERTY, Q_INVOKABLE and public slot declarations
+  /// of the headers are scanned, and the wrapper classes get decorator
+  /// slots calling them directly, see ctkPythonQtWrapperMembers. They
+  /// replace the @Decorators@ variable of the class wrapper templates.
+  /// Disabled by default.
+  bool decoratorsEnabled()const;
+  void setDecoratorsEnabled(bool value);
+
+  /// If enabled, the header only declares the wrapper classes, with the
+  /// ClassWrapperDeclaration*Template, and forward declares the wrapped
+  /// classes. The slots are defined in the init file, with the
+  /// ClassWrapperDefinition*Template, which includes the wrapped headers.
+  /// Changing a wrapped header then recompiles the init file only, and moc
+  /// doesn't parse it. Wrapped classes with decorators are still included
+  /// by the header, their decorator slots being inline.
+  /// Disabled by default.
+  bool splitWrappersEnabled()const;
+  void setSplitWrappersEnabled(bool value);
+
+  /// If enabled, the constructors, the base class and the abstractness of
+  /// the classes are found by parsing the headers with libclang, see
+  /// ctkPythonQtWrapperClangAnalyzer, instead of matching their text. Headers
+  /// in which libclang finds no class definition fall back to the text
+  /// matching. Disabled by default.
+  /// Return false if PythonQtWrapper has been built without
+  /// PythonQtWrapper_USE_LIBCLANG.
+  bool clangBackendEnabled()const;
+  bool setClangBackendEnabled(bool value);
+
+  /// Compiler arguments and precompiled preamble of the libclang backend.
+  ctkPythonQtWrapperClangAnalyzer& clangAnalyzer();
+
+  /// Analyses reused by validateInputFiles() for the input files which
+  /// didn't change since a previous run with the same analysis options. The
+  /// cache is not owned by the wrapper. None by default.
+  ctkPythonQtWrapperAnalysisCache* analysisCache()const;
+  void setAnalysisCache(ctkPythonQtWrapperAnalysisCache* cache);
+
+  /// Registry file shared with the other targets, see
+  /// ctkPythonQtWrapperRegistry. Empty by default, meaning every class is
+  /// wrapped by the target.
+  QString registryFile()const;
+  void setRegistryFile(const QString& newRegistryFile);
+
+  /// Record the target as the owner of its valid classes which are not
+  /// owned by another target yet, and release the classes it doesn't wrap
+  /// anymore. Classes owned by another target are not wrapped nor
+  /// registered by this one, the target is recorded as one of their users.
+  /// Called by generateOutputs(), it must be called before
+  /// generateOutputBuffers().
+  ///
+  /// A released class is not wrapped by its users until they are generated
+  /// again: the build must make the generation of the users depend on the
+  /// generation of the owner. A warning is logged for every released class
+  /// which still has users, see releasedClasses().
+  bool updateRegistry();
+
+  /// Classes wrapped by another target, with their owner as
+  /// "<wrapping-namespace> <target-name>".
+  const QHash<QString, QString>& externalClasses()const;
+
+  /// Classes released by the last updateRegistry() while other targets
+  /// still list them, with those targets as "<wrapping-namespace> <target-name>".
+  const QHash<QString, QStringList>& releasedClasses()const;
+
+  /// Add \a pathToCppHeaders to the inputs, warning about the missing ones
+  /// which validateInputFiles() then rejects. Return false if none exists.
   bool setInput(const QStringList& pathToCppHeaders);
+  /// Add the headers found below \a directory, see
+  /// ctkPythonQtWrapperDirectoryScanner, to the inputs. The directories are
+  /// listed by maximumThreadCount() threads, and a warning is logged for
+  /// every subdirectory which can't be listed.
+  bool addInputDirectory(const QString& directory,
+                         const QStringList& includePatterns = QStringList(),
+                         const QStringList& excludePatterns = QStringList());
+  const QStringList& inputFiles()const;
+
+  /// Add a header whose \a content is already in memory. \a filePath is
+  /// only used to derive the class name and in diagnostics, the file does not
+  /// have to exist.
+  void addInput(const QString& filePath, const QByteArray& content);
+
   bool setOutput(const QString& outputFile);
 
+  /// Analyse every input header and return the number of rejected ones.
+  /// Headers are streamed through a ctkPythonQtWrapperPipeline using up to
+  /// maximumThreadCount() threads, and only a bounded number of them are
+  /// held in memory at once.
   int validateInputFiles();
+
+  /// Analysis of the input headers, in input order.
+  /// Empty until validateInputFiles() or generateOutputs() is called.
+  const QList<ctkPythonQtWrapperAnalysis>& analyses()const;
+
+  /// Print one message per rejected header on the standard error while
+  /// validating. Enabled by default.
+  bool rejectionMessagesEnabled()const;
+  void setRejectionMessagesEnabled(bool value);
+
+  /// Write the verdict of every analysed header to \a device, one line per
+  /// header with the tab separated fields: path, "accepted" or "rejected",
+  /// parent class name and reason.
+  bool writeCheckReport(QIODevice* device)const;
+
+  /// Return true if the header located at \a filePath can be wrapped,
+  /// otherwise set lastError() to the reason. Shortcut for analyze().
   bool validate(const QString& filePath);
 
+  /// Read and analyse the header located at \a filePath.
+  /// The analysis functions below are reentrant: they only read their
+  /// arguments, so they can be called concurrently on the same wrapper.
+  ctkPythonQtWrapperAnalysis analyze(const QString& filePath)const;
+  /// \a keywordHints are the ctkPythonQtWrapperKeywordFilter::Keyword
+  /// found in the raw content, checks depending on a missing keyword are
+  /// skipped.
+  ctkPythonQtWrapperAnalysis analyze(const QString& filePath, const QString& content,
+                                     int keywordHints = ctkPythonQtWrapperKeywordFilter::AllKeywords)const;
+
+  /// Content of the input \a filePath, either registered with addInput() or
+  /// read from disk.
+  bool readInput(const QString& filePath, QString& content, QString& errorString)const;
+
+  /// Content of \a filePath if it has been registered with addInput().
+  bool inputBuffer(const QString& filePath, QString& content)const;
+
+  /// Decode raw header bytes the same way header files are decoded.
+  static QString decodeInput(const QByteArray& buffer);
+
+  /// Analyse \a filePath again, e.g. after it changed on disk, and return
+  /// true if its analysis differs from the one previously computed.
+  bool updateAnalysis(const QString& filePath);
+
+  /// Generate the wrapper sources and return them keyed by their path
+  /// relative to the output directory. Only the accepted headers are
+  /// included and wrapped.
+  QMap<QString, QByteArray> generateOutputBuffers();
+
+  /// Write the buffers returned by generateOutputBuffers() below the
+  /// output directory. Files whose content is unchanged are not touched, so
+  /// that their timestamp does not trigger a rebuild.
   bool generateOutputs();
+  /// Write \a outputs, keyed by their path relative to the output directory,
+  /// creating the directories as needed.
+  bool writeOutputBuffers(const QMap<QString, QByteArray>& outputs);
+
+  /// Directory, relative to the output directory, of the generated files.
+  QString outputDirectoryName()const;
+  QString headerFileName()const;
+  QString initFileName()const;
 
-  QString generateClassWrapperCode(const QString& className, const QString& parentClassName);
-  QString generateRegisterClassCode(const QString& className, const QString& targetName);
+  QString generateHeaderCode()const;
+  QString generateInitCode()const;
 
-  bool isRegularHeader(const QString& filePath);
-  bool isPimplHeader(const QString& filePath);
+  /// Content of the generated files without their includes and macro
+  /// definitions, i.e. without headerPrologueCode() for the header. They
+  /// can be concatenated with the bodies of other targets.
+  QString generateHeaderBodyCode()const;
+  QString generateInitBodyCode()const;
+  /// Includes and macro definitions the header bodies depend on.
+  static QString headerPrologueCode();
 
-  bool hasQObjectMacro(const QString& filePath);
-  bool hasValidConstructor(const QString& filePath, const QString& className);
-  bool hasVirtualPureMethod(const QString& filePath);
+  QString generateClassWrapperCode(const QString& className, const QString& parentClassName)const;
+  /// Out of line slots of the wrapper class, see setSplitWrappersEnabled().
+  QString generateClassWrapperDefinitionCode(const QString& className,
+                                             const QString& parentClassName)const;
+  QString generateRegisterClassCode(const QString& className, const QString& targetName)const;
 
-  bool extractParentClassName(const QString& filePath, const QString& className,
-                              QString& parentClassName);
+  /// Replace the template of \a type. Return false and set lastError() if
+  /// \a text references an unknown variable.
+  bool setTemplate(TemplateType type, const QString& text);
+
+  /// Load the templates found in \a directory, named after
+  /// templateFileName(). Templates without a file keep their current value.
+  bool loadTemplates(const QString& directory);
+
+  static QString templateFileName(TemplateType type);
+  static QString defaultTemplate(TemplateType type);
+
+  /// Preprocessor code defining PythonQtWrapper_HIDDEN, and \a exportMacro,
+  /// unless they are already defined.
+  static QString hiddenMacroDefinition();
+  static QString exportMacroDefinition(const QString& exportMacro);
+  /// Preprocessor code defining PythonQtWrapper_EXTERN_TEMPLATES if the
+  /// compiler supports extern template, unless
+  /// PythonQtWrapper_NO_EXTERN_TEMPLATES is defined. The header then declares
+  /// the PythonQtCreateObject() instantiations extern, so that they are only
+  /// instantiated by the init file.
+  static QString externTemplateMacroDefinition();
+
+  static bool isRegularHeader(const QString& filePath);
+  static bool isPimplHeader(const QString& filePath);
+
+  static bool hasQObjectMacro(const QString& content);
+  static bool hasValidConstructor(const QString& content, const QString& className);
+  static bool hasVirtualPureMethod(const QString& content);
+
+  static bool extractParentClassName(const QString& content, const QString& className,
+                                     QString& parentClassName);
+  static bool extractBaseClassName(const QString& content, const QString& className,
+                                   QString& baseClassName);
 
 private:
+  /// Extract the members of \a analysis and mark it valid, unless it has
+  /// been rejected.
+  ctkPythonQtWrapperAnalysis completeAnalysis(ctkPythonQtWrapperAnalysis analysis,
+                                              const QString& content)const;
+
+  /// Options the analyses depend on, see setAnalysisCache().
+  QString analysisOptions()const;
+
+  /// Set the values of the variables which don't depend on the class.
+  void initializeTemplateValues(QString* values)const;
+
+  /// Analyses of the classes wrapped by the target, i.e. without the
+  /// rejected headers and the external classes.
+  QList<ctkPythonQtWrapperAnalysis> generatedAnalyses()const;
+
+  /// Classes of the target which are the base class of another class of
+  /// the target, in input order.
+  QStringList polymorphicBaseClassNames()const;
+
   QString     ProgramName;
 
   QStringList PathToExistingCppHeaders;
+  QHash<QString, QString> InputBuffers;
+  QList<ctkPythonQtWrapperAnalysis> Analyses;
   QString     OutputDir;
 
-  bool        Verbose;
+  mutable ctkPythonQtWrapperLogger Logger;
+  bool        RejectionMessagesEnabled;
+  int         MaximumThreadCount;
   QString     LastError;
 
   QString     WrappingNamespace;
   QString     TargetName;
+  QString     ExportMacro;
+  QString     ExportHeader;
+  bool        PolymorphicHandlersEnabled;
+  bool        DecoratorsEnabled;
+  bool        ClangBackendEnabled;
+  bool        SplitWrappersEnabled;
+  QString     RegistryFile;
+  QHash<QString, QString> ExternalClasses;
+  QHash<QString, QStringList> ReleasedClasses;
+
+  ctkPythonQtWrapperTemplate Templates[TemplateCount];
+  ctkPythonQtWrapperClangAnalyzer ClangAnalyzer;
+  ctkPythonQtWrapperAnalysisCache* AnalysisCache;
 };
 
 #endif
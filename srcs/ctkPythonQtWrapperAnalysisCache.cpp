@@ -0,0 +1,143 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperAnalysisCache.h"
+
+// STD includes
+#ifndef _WIN32
+# include <sys/stat.h>
+#endif
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysisCache::ctkPythonQtWrapperAnalysisCache()
+{
+  this->HitCount = 0;
+  this->MissCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysisCache::Stamp ctkPythonQtWrapperAnalysisCache::fileStamp(
+  const QString& filePath)
+{
+  Stamp stamp;
+#ifdef _WIN32
+  // Modification times are only exposed with a one second resolution
+  QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists())
+    {
+    return stamp;
+    }
+  stamp.Size = fileInfo.size();
+  stamp.ModificationTime = fileInfo.lastModified().toTime_t();
+  stamp.ChangeTime = fileInfo.created().toTime_t();
+#else
+  struct stat status;
+  if (::stat(QFile::encodeName(filePath).constData(), &status) != 0)
+    {
+    return stamp;
+    }
+  stamp.Size = status.st_size;
+  stamp.ModificationTime = status.st_mtime;
+  stamp.ChangeTime = status.st_ctime;
+# if defined(__APPLE__)
+  stamp.ModificationNanoseconds = status.st_mtimespec.tv_nsec;
+  stamp.ChangeNanoseconds = status.st_ctimespec.tv_nsec;
+# else
+  stamp.ModificationNanoseconds = status.st_mtim.tv_nsec;
+  stamp.ChangeNanoseconds = status.st_ctim.tv_nsec;
+# endif
+  stamp.Inode = status.st_ino;
+#endif
+  return stamp;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperAnalysisCache::find(const QString& filePath, const Stamp& stamp,
+                                           const QString& options,
+                                           ctkPythonQtWrapperAnalysis& analysis)const
+{
+  QHash<QString, Entry>::const_iterator entry =
+      this->Entries.constFind(QFileInfo(filePath).absoluteFilePath());
+  // The analysis holds the path as given by the run which inserted it
+  if (!stamp.isValid() || entry == this->Entries.constEnd()
+      || !(entry.value().FileStamp == stamp) || entry.value().Options != options
+      || entry.value().Analysis.FilePath != filePath)
+    {
+    ++this->MissCount;
+    return false;
+    }
+  analysis = entry.value().Analysis;
+  ++this->HitCount;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperAnalysisCache::insert(const QString& filePath, const Stamp& stamp,
+                                             const QString& options,
+                                             const ctkPythonQtWrapperAnalysis& analysis)
+{
+  QString key = QFileInfo(filePath).absoluteFilePath();
+  if (!stamp.isValid())
+    {
+    this->Entries.remove(key);
+    return;
+    }
+  Entry& entry = this->Entries[key];
+  entry.FileStamp = stamp;
+  entry.Options = options;
+  entry.Analysis = analysis;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperAnalysisCache::count()const
+{
+  return this->Entries.count();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperAnalysisCache::clear()
+{
+  this->Entries.clear();
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperAnalysisCache::hitCount()const
+{
+  return this->HitCount;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperAnalysisCache::missCount()const
+{
+  return this->MissCount;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperAnalysisCache::resetStatistics()
+{
+  this->HitCount = 0;
+  this->MissCount = 0;
+}
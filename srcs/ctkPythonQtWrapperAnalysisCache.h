@@ -0,0 +1,107 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperAnalysisCache_h
+#define __ctkPythonQtWrapperAnalysisCache_h
+
+// Qt includes
+#include <QHash>
+#include <QString>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+
+/**
+ * Analyses of header files kept across runs of ctkPythonQtWrapper in the
+ * same process, e.g. by the requests of a generator server.
+ *
+ * An analysis is reused as long as the file has the same Stamp (size,
+ * modification and change times, and inode where available) and the
+ * wrapper has the same analysis options (see
+ * ctkPythonQtWrapper::setAnalysisCache()). The stamp is taken before the
+ * file is read, so that a file modified while being analysed is analysed
+ * again by the next run.
+ *
+ * The cache is not thread-safe, it is only used by the thread calling
+ * ctkPythonQtWrapper::validateInputFiles().
+ */
+class ctkPythonQtWrapperAnalysisCache
+{
+public:
+  class Stamp
+  {
+  public:
+    Stamp() : Size(-1), ModificationTime(0), ModificationNanoseconds(0),
+              ChangeTime(0), ChangeNanoseconds(0), Inode(0) {}
+    bool operator==(const Stamp& other)const
+    {
+      return this->Size == other.Size
+          && this->ModificationTime == other.ModificationTime
+          && this->ModificationNanoseconds == other.ModificationNanoseconds
+          && this->ChangeTime == other.ChangeTime
+          && this->ChangeNanoseconds == other.ChangeNanoseconds
+          && this->Inode == other.Inode;
+    }
+    /// False if the file couldn't be stat'ed.
+    bool isValid()const { return this->Size >= 0; }
+
+    qint64  Size;
+    qint64  ModificationTime;
+    qint64  ModificationNanoseconds;
+    qint64  ChangeTime;
+    qint64  ChangeNanoseconds;
+    quint64 Inode;
+  };
+
+  ctkPythonQtWrapperAnalysisCache();
+
+  static Stamp fileStamp(const QString& filePath);
+
+  /// Set \a analysis to the analysis of \a filePath if it has been inserted
+  /// with the same \a stamp and \a options.
+  bool find(const QString& filePath, const Stamp& stamp, const QString& options,
+            ctkPythonQtWrapperAnalysis& analysis)const;
+  void insert(const QString& filePath, const Stamp& stamp, const QString& options,
+              const ctkPythonQtWrapperAnalysis& analysis);
+
+  int count()const;
+  void clear();
+
+  /// Number of successful find() since the last resetStatistics().
+  int hitCount()const;
+  int missCount()const;
+  void resetStatistics();
+
+private:
+  class Entry
+  {
+  public:
+    Stamp   FileStamp;
+    QString Options;
+    ctkPythonQtWrapperAnalysis Analysis;
+  };
+
+  /// Keyed by absolute file path
+  QHash<QString, Entry> Entries;
+  mutable int HitCount;
+  mutable int MissCount;
+};
+
+#endif
@@ -0,0 +1,580 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QVector>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperClangAnalyzer.h"
+#include "ctkPythonQtWrapperConfigure.h"
+
+#ifdef PythonQtWrapper_USE_LIBCLANG
+# include <clang-c/Index.h>
+#endif
+
+namespace
+{
+#ifdef PythonQtWrapper_USE_LIBCLANG
+//-----------------------------------------------------------------------------
+QString toQString(CXString string)
+{
+  QString result = QString::fromUtf8(clang_getCString(string));
+  clang_disposeString(string);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+QString cursorSpelling(CXCursor cursor)
+{
+  return toQString(clang_getCursorSpelling(cursor));
+}
+
+//-----------------------------------------------------------------------------
+// Command line passed to libclang, which keeps pointers to the strings
+class ClangCommandLine
+{
+public:
+  ClangCommandLine(const QStringList& arguments)
+  {
+    foreach(const QString& argument, arguments)
+      {
+      this->Buffers << argument.toLocal8Bit();
+      }
+    foreach(const QByteArray& buffer, this->Buffers)
+      {
+      this->Pointers << buffer.constData();
+      }
+  }
+  const char* const* data()const { return this->Pointers.constData(); }
+  int size()const { return this->Pointers.size(); }
+
+private:
+  QList<QByteArray>    Buffers;
+  QVector<const char*> Pointers;
+};
+
+//-----------------------------------------------------------------------------
+// Release the index and the translation unit when going out of scope
+class ClangTranslationUnit
+{
+public:
+  ClangTranslationUnit()
+  {
+    // Don't enumerate the declarations of the precompiled preamble
+    this->Index = clang_createIndex(/*excludeDeclarationsFromPCH=*/1, /*displayDiagnostics=*/0);
+    this->Unit = 0;
+  }
+  ~ClangTranslationUnit()
+  {
+    if (this->Unit)
+      {
+      clang_disposeTranslationUnit(this->Unit);
+      }
+    clang_disposeIndex(this->Index);
+  }
+
+  bool parse(const QString& filePath, const QStringList& arguments,
+             CXUnsavedFile* unsavedFile, unsigned options)
+  {
+    QByteArray fileName = QFile::encodeName(filePath);
+    ClangCommandLine commandLine(arguments);
+    this->Unit = clang_parseTranslationUnit(this->Index, fileName.constData(),
+                                            commandLine.data(), commandLine.size(),
+                                            unsavedFile, unsavedFile ? 1 : 0, options);
+    return this->Unit != 0;
+  }
+
+  /// First error reported while parsing, empty if there is none.
+  QString firstError()const
+  {
+    unsigned count = clang_getNumDiagnostics(this->Unit);
+    for (unsigned i = 0; i < count; ++i)
+      {
+      CXDiagnostic diagnostic = clang_getDiagnostic(this->Unit, i);
+      QString error;
+      if (clang_getDiagnosticSeverity(diagnostic) >= CXDiagnostic_Error)
+        {
+        error = toQString(clang_formatDiagnostic(diagnostic, clang_defaultDiagnosticDisplayOptions()));
+        }
+      clang_disposeDiagnostic(diagnostic);
+      if (!error.isEmpty())
+        {
+        return error;
+        }
+      }
+    return QString();
+  }
+
+  CXIndex           Index;
+  CXTranslationUnit Unit;
+};
+
+//-----------------------------------------------------------------------------
+class ClassSearch
+{
+public:
+  ClassSearch(const QString& className) : ClassName(className), Found(false) {}
+  QString  ClassName;
+  CXCursor Definition;
+  bool     Found;
+};
+
+//-----------------------------------------------------------------------------
+CXChildVisitResult findClassDefinition(CXCursor cursor, CXCursor /*parent*/, CXClientData data)
+{
+  ClassSearch* search = static_cast<ClassSearch*>(data);
+  if (!clang_Location_isFromMainFile(clang_getCursorLocation(cursor)))
+    {
+    return CXChildVisit_Continue;
+    }
+  CXCursorKind kind = clang_getCursorKind(cursor);
+  if (kind == CXCursor_Namespace)
+    {
+    return CXChildVisit_Recurse;
+    }
+  if ((kind == CXCursor_ClassDecl || kind == CXCursor_StructDecl)
+      && clang_isCursorDefinition(cursor)
+      && cursorSpelling(cursor) == search->ClassName)
+    {
+    search->Definition = cursor;
+    search->Found = true;
+    return CXChildVisit_Break;
+    }
+  return CXChildVisit_Continue;
+}
+
+//-----------------------------------------------------------------------------
+CXChildVisitResult findDefaultArgument(CXCursor cursor, CXCursor /*parent*/, CXClientData data)
+{
+  if (clang_isExpression(clang_getCursorKind(cursor)))
+    {
+    *static_cast<bool*>(data) = true;
+    return CXChildVisit_Break;
+    }
+  return CXChildVisit_Continue;
+}
+
+//-----------------------------------------------------------------------------
+bool hasDefaultArgument(CXCursor parameter)
+{
+  bool found = false;
+  clang_visitChildren(parameter, findDefaultArgument, &found);
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+// Name of the class pointed to by \a type, empty if it isn't a pointer to a
+// class
+QString pointeeClassName(CXType type)
+{
+  type = clang_getCanonicalType(type);
+  if (type.kind != CXType_Pointer)
+    {
+    return QString();
+    }
+  CXCursor declaration = clang_getTypeDeclaration(clang_getPointeeType(type));
+  if (clang_Cursor_isNull(declaration))
+    {
+    return QString();
+    }
+  return cursorSpelling(declaration);
+}
+
+//-----------------------------------------------------------------------------
+class ClassMembers
+{
+public:
+  ClassMembers()
+    : ConstructorCount(0), HasDefaultConstructor(false),
+      HasQObjectConstructor(false), HasQWidgetConstructor(false),
+      HasPureVirtualMethod(false) {}
+
+  QString BaseClassName;
+  int     ConstructorCount;
+  /// Public constructors without parameters, or whose only mandatory
+  /// parameter is the parent
+  bool    HasDefaultConstructor;
+  bool    HasQObjectConstructor;
+  bool    HasQWidgetConstructor;
+  bool    HasPureVirtualMethod;
+};
+
+//-----------------------------------------------------------------------------
+void visitConstructor(CXCursor cursor, ClassMembers* members)
+{
+  members->ConstructorCount++;
+  if (clang_getCXXAccessSpecifier(cursor) != CX_CXXPublic)
+    {
+    return;
+    }
+  int parameterCount = clang_Cursor_getNumArguments(cursor);
+  if (parameterCount == 0)
+    {
+    members->HasDefaultConstructor = true;
+    return;
+    }
+  for (int i = 1; i < parameterCount; ++i)
+    {
+    if (!hasDefaultArgument(clang_Cursor_getArgument(cursor, i)))
+      {
+      return;
+      }
+    }
+  QString parentClassName = pointeeClassName(
+        clang_getCursorType(clang_Cursor_getArgument(cursor, 0)));
+  if (parentClassName == QLatin1String("QObject"))
+    {
+    members->HasQObjectConstructor = true;
+    }
+  else if (parentClassName == QLatin1String("QWidget"))
+    {
+    members->HasQWidgetConstructor = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+CXChildVisitResult visitClassMember(CXCursor cursor, CXCursor /*parent*/, CXClientData data)
+{
+  ClassMembers* members = static_cast<ClassMembers*>(data);
+  switch (clang_getCursorKind(cursor))
+    {
+    case CXCursor_CXXBaseSpecifier:
+      if (members->BaseClassName.isEmpty())
+        {
+        CXType baseType = clang_getCursorType(cursor);
+        CXCursor declaration = clang_getTypeDeclaration(baseType);
+        // Same as the text matching: template arguments are kept
+        members->BaseClassName =
+            clang_Cursor_isNull(declaration) || clang_Type_getNumTemplateArguments(baseType) > 0 ?
+              toQString(clang_getTypeSpelling(baseType)) : cursorSpelling(declaration);
+        }
+      break;
+    case CXCursor_Constructor:
+      visitConstructor(cursor, members);
+      break;
+    case CXCursor_CXXMethod:
+      if (clang_CXXMethod_isPureVirtual(cursor))
+        {
+        members->HasPureVirtualMethod = true;
+        }
+      break;
+    default:
+      break;
+    }
+  return CXChildVisit_Continue;
+}
+
+//-----------------------------------------------------------------------------
+const unsigned ParseOptions =
+    CXTranslationUnit_Incomplete | CXTranslationUnit_SkipFunctionBodies;
+#endif
+
+//-----------------------------------------------------------------------------
+QString preambleSource(const QStringList& headers)
+{
+  QString source;
+  foreach(const QString& header, headers)
+    {
+    source += QString("#include <%1>\n").arg(header);
+    }
+  return source;
+}
+
+//-----------------------------------------------------------------------------
+bool readFile(const QString& filePath, QByteArray& content)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return false;
+    }
+  content = file.readAll();
+  return true;
+}
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperClangAnalyzer::ctkPythonQtWrapperClangAnalyzer()
+{
+  this->PreambleHeaders << "QObject" << "QWidget";
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperClangAnalyzer::~ctkPythonQtWrapperClangAnalyzer()
+{
+  this->removeTemporaryPreamble();
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperClangAnalyzer::isAvailable()
+{
+#ifdef PythonQtWrapper_USE_LIBCLANG
+  return true;
+#else
+  return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperClangAnalyzer::arguments()const
+{
+  return this->Arguments;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperClangAnalyzer::setArguments(const QStringList& arguments)
+{
+  this->Arguments = arguments;
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperClangAnalyzer::preambleHeaders()const
+{
+  return this->PreambleHeaders;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperClangAnalyzer::setPreambleHeaders(const QStringList& headers)
+{
+  this->PreambleHeaders = headers;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperClangAnalyzer::preambleFile()const
+{
+  return this->PreambleFile;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperClangAnalyzer::setPreambleFile(const QString& fileName)
+{
+  this->PreambleFile = fileName;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperClangAnalyzer::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperClangAnalyzer::removeTemporaryPreamble()
+{
+  if (this->TemporaryPreambleFile.isEmpty())
+    {
+    return;
+    }
+  QFile::remove(this->TemporaryPreambleFile);
+  QFile::remove(this->TemporaryPreambleFile + ".h");
+  if (this->PreparedPreambleFile == this->TemporaryPreambleFile)
+    {
+    this->PreparedPreambleFile.clear();
+    }
+  this->TemporaryPreambleFile.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperClangAnalyzer::prepare()
+{
+  this->ErrorString.clear();
+  this->PreparedPreambleFile.clear();
+  this->removeTemporaryPreamble();
+#ifdef PythonQtWrapper_USE_LIBCLANG
+  if (this->PreambleHeaders.isEmpty())
+    {
+    return true;
+    }
+
+  QString preambleFile = this->PreambleFile;
+  if (preambleFile.isEmpty())
+    {
+    // Wrappers of the same process, e.g. the targets of a module, don't
+    // share their temporary preamble
+    preambleFile = QDir::temp().filePath(QString("PythonQtWrapper-%1-%2.pch").arg(
+          QCoreApplication::applicationPid()).arg(reinterpret_cast<quintptr>(this), 0, 16));
+    this->TemporaryPreambleFile = preambleFile;
+    }
+  else if (this->isPreambleValid())
+    {
+    this->PreparedPreambleFile = preambleFile;
+    return true;
+    }
+
+  // The preamble is compiled from a file on disk, so that libclang can
+  // check that it is up to date when loading it
+  QString sourceFile = preambleFile + ".h";
+  QFile source(sourceFile);
+  if (!source.open(QIODevice::WriteOnly | QIODevice::Truncate)
+      || source.write(preambleSource(this->PreambleHeaders).toLocal8Bit()) < 0)
+    {
+    this->ErrorString = QString("%1 - %2").arg(sourceFile, source.errorString());
+    return false;
+    }
+  source.close();
+
+  QStringList arguments = this->Arguments;
+  arguments << "-x" << "c++-header";
+  ClangTranslationUnit translationUnit;
+  if (!translationUnit.parse(sourceFile, arguments, 0,
+                             ParseOptions | CXTranslationUnit_ForSerialization))
+    {
+    this->ErrorString = QString("%1 - Failed to parse the preamble").arg(sourceFile);
+    return false;
+    }
+  QString error = translationUnit.firstError();
+  if (!error.isEmpty())
+    {
+    this->ErrorString = QString("%1 - %2").arg(sourceFile, error);
+    return false;
+    }
+  if (clang_saveTranslationUnit(translationUnit.Unit, QFile::encodeName(preambleFile).constData(),
+                                clang_defaultSaveOptions(translationUnit.Unit)) != CXSaveError_None)
+    {
+    this->ErrorString = QString("%1 - Failed to save the preamble").arg(preambleFile);
+    return false;
+    }
+  this->PreparedPreambleFile = preambleFile;
+  return true;
+#else
+  this->ErrorString = "PythonQtWrapper has been built without libclang";
+  return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperClangAnalyzer::isPreambleValid()const
+{
+#ifdef PythonQtWrapper_USE_LIBCLANG
+  QByteArray source;
+  if (!QFile::exists(this->PreambleFile)
+      || !readFile(this->PreambleFile + ".h", source)
+      || source != preambleSource(this->PreambleHeaders).toLocal8Bit())
+    {
+    return false;
+    }
+  // libclang refuses a preamble older than the headers it includes, or
+  // compiled with different arguments
+  QByteArray emptyFileName = QFile::encodeName(this->PreambleFile + ".cpp");
+  CXUnsavedFile emptyFile;
+  emptyFile.Filename = emptyFileName.constData();
+  emptyFile.Contents = "";
+  emptyFile.Length = 0;
+  QStringList arguments = this->Arguments;
+  arguments << "-x" << "c++" << "-include-pch" << this->PreambleFile;
+  ClangTranslationUnit translationUnit;
+  return translationUnit.parse(this->PreambleFile + ".cpp", arguments, &emptyFile, ParseOptions)
+      && translationUnit.firstError().isEmpty();
+#else
+  return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperClangAnalyzer::analyze(const QString& filePath, const QString& content,
+                                              ctkPythonQtWrapperAnalysis& analysis,
+                                              QString& errorString)const
+{
+#ifdef PythonQtWrapper_USE_LIBCLANG
+  QByteArray fileName = QFile::encodeName(filePath);
+  QByteArray contentBuffer = content.toUtf8();
+  CXUnsavedFile unsavedFile;
+  unsavedFile.Filename = fileName.constData();
+  unsavedFile.Contents = contentBuffer.constData();
+  unsavedFile.Length = static_cast<unsigned long>(contentBuffer.size());
+
+  QStringList arguments = this->Arguments;
+  arguments << "-x" << "c++";
+  if (!this->PreparedPreambleFile.isEmpty())
+    {
+    arguments << "-include-pch" << this->PreparedPreambleFile;
+    }
+  ClangTranslationUnit translationUnit;
+  if (!translationUnit.parse(filePath, arguments, &unsavedFile, ParseOptions))
+    {
+    errorString = QString("%1 - libclang failed to parse the header").arg(filePath);
+    return false;
+    }
+  // Error recovery drops the declarations it can't make sense of, e.g. a
+  // constructor taking a type from a missing include, which would turn
+  // into a wrong verdict rather than a failure
+  QString error = translationUnit.firstError();
+  if (!error.isEmpty())
+    {
+    errorString = QString("%1 - libclang failed to parse the header: %2").arg(filePath, error);
+    return false;
+    }
+
+  ClassSearch search(analysis.ClassName);
+  clang_visitChildren(clang_getTranslationUnitCursor(translationUnit.Unit),
+                      findClassDefinition, &search);
+  if (!search.Found)
+    {
+    errorString = QString("%1 - libclang found no definition of %2").arg(
+          filePath, analysis.ClassName);
+    return false;
+    }
+
+  ClassMembers members;
+  clang_visitChildren(search.Definition, visitClassMember, &members);
+  analysis.BaseClassName = members.BaseClassName;
+
+  bool isAbstract = members.HasPureVirtualMethod;
+#if CINDEX_VERSION_MINOR >= 45
+  // Also covers the pure virtual methods inherited and not overridden
+  isAbstract = isAbstract || clang_CXXRecord_isAbstract(search.Definition);
+#endif
+  if (isAbstract)
+    {
+    analysis.reject("Contains a virtual pure method");
+    return true;
+    }
+
+  // Same preference as ctkPythonQtWrapper::extractParentClassName(). A
+  // class declaring no constructor has an implicit default one.
+  analysis.ParentClassName.clear();
+  if (members.HasDefaultConstructor || members.ConstructorCount == 0)
+    {
+    return true;
+    }
+  if (members.HasQObjectConstructor)
+    {
+    analysis.ParentClassName = QLatin1String("QObject");
+    }
+  else if (members.HasQWidgetConstructor)
+    {
+    analysis.ParentClassName = QLatin1String("QWidget");
+    }
+  else
+    {
+    analysis.reject("Missing expected constructor signature");
+    }
+  return true;
+#else
+  Q_UNUSED(filePath);
+  Q_UNUSED(content);
+  Q_UNUSED(analysis);
+  errorString = "PythonQtWrapper has been built without libclang";
+  return false;
+#endif
+}
@@ -0,0 +1,96 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperClangAnalyzer_h
+#define __ctkPythonQtWrapperClangAnalyzer_h
+
+// Qt includes
+#include <QStringList>
+
+class ctkPythonQtWrapperAnalysis;
+
+/**
+ * Analysis of a header with libclang.
+ *
+ * Unlike the text heuristics of ctkPythonQtWrapper, the class is looked up
+ * in the AST: its first base class, its public constructors and whether it
+ * is abstract, including the pure virtual methods it inherits, are exact.
+ *
+ * Parsing the Qt headers included by every input dominates the cost of a
+ * parse. prepare() therefore compiles the preambleHeaders() once into a
+ * precompiled header, and every header is then parsed with -include-pch,
+ * skipping the function bodies. The AST of the precompiled headers is not
+ * visited.
+ *
+ * Only available when built with PythonQtWrapper_USE_LIBCLANG, see
+ * isAvailable().
+ */
+class ctkPythonQtWrapperClangAnalyzer
+{
+public:
+  ctkPythonQtWrapperClangAnalyzer();
+  /// Remove the precompiled preamble if it is a temporary file.
+  ~ctkPythonQtWrapperClangAnalyzer();
+
+  static bool isAvailable();
+
+  /// Compiler arguments, e.g. the -I options locating the Qt headers and
+  /// the -D options of the target.
+  QStringList arguments()const;
+  void setArguments(const QStringList& arguments);
+
+  /// Headers compiled into the precompiled preamble. Defaults to
+  /// <QObject> and <QWidget>.
+  QStringList preambleHeaders()const;
+  void setPreambleHeaders(const QStringList& headers);
+
+  /// Precompiled preamble, reused by the next runs as long as libclang
+  /// accepts it. If empty, the preamble is a temporary file.
+  QString preambleFile()const;
+  void setPreambleFile(const QString& fileName);
+
+  /// Build the precompiled preamble, unless the preamble file is up to date.
+  /// On failure, the headers are parsed without preamble.
+  bool prepare();
+  QString errorString()const;
+
+  /// Parse \a content and complete \a analysis, whose ClassName must be set:
+  /// set its ParentClassName and BaseClassName, or reject it. Return false
+  /// and set \a errorString if libclang reported an error or the class
+  /// could not be found, in which case \a analysis is untouched and the
+  /// caller falls back to matching the text of the header.
+  /// It is reentrant: it can be called concurrently once prepare() returned.
+  bool analyze(const QString& filePath, const QString& content,
+               ctkPythonQtWrapperAnalysis& analysis, QString& errorString)const;
+
+private:
+  bool isPreambleValid()const;
+  void removeTemporaryPreamble();
+
+  QStringList Arguments;
+  QStringList PreambleHeaders;
+  QString     PreambleFile;
+  /// Preamble actually used by analyze(), empty if there is none.
+  QString     PreparedPreambleFile;
+  QString     TemporaryPreambleFile;
+  QString     ErrorString;
+};
+
+#endif
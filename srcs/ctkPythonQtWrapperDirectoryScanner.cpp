@@ -0,0 +1,361 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QPair>
+#include <QRegExp>
+#include <QRunnable>
+#include <QThread>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperDirectoryScanner.h"
+
+// STD includes
+#ifndef Q_OS_WIN
+# include <dirent.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+#endif
+
+namespace
+{
+enum EntryType
+  {
+  OtherEntry = 0,
+  FileEntry,
+  DirectoryEntry
+  };
+typedef QPair<QString, EntryType> Entry;
+
+#ifndef Q_OS_WIN
+//-----------------------------------------------------------------------------
+// Type of \a path, where symbolic links to files are files and symbolic
+// links to directories are neither files nor directories.
+EntryType statEntry(const QByteArray& path)
+{
+  struct stat status;
+  if (lstat(path.constData(), &status) != 0)
+    {
+    return OtherEntry;
+    }
+  if (S_ISLNK(status.st_mode))
+    {
+    return stat(path.constData(), &status) == 0 && S_ISREG(status.st_mode) ?
+          FileEntry : OtherEntry;
+    }
+  if (S_ISREG(status.st_mode))
+    {
+    return FileEntry;
+    }
+  return S_ISDIR(status.st_mode) ? DirectoryEntry : OtherEntry;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// List the files and directories of \a path, stat'ing the entries only if
+// the file system doesn't report their type
+bool readDirectory(const QString& path, QList<Entry>& entries)
+{
+#ifdef Q_OS_WIN
+  if (!QFileInfo(path).isReadable())
+    {
+    return false;
+    }
+  QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+  while (it.hasNext())
+    {
+    it.next();
+    QFileInfo info = it.fileInfo();
+    if (info.isSymLink() && info.isDir())
+      {
+      continue;
+      }
+    entries << Entry(it.fileName(), info.isDir() ? DirectoryEntry : FileEntry);
+    }
+  return true;
+#else
+  QByteArray encodedPath = QFile::encodeName(path);
+  DIR* directory = opendir(encodedPath.constData());
+  if (!directory)
+    {
+    return false;
+    }
+  struct dirent* entry;
+  while ((entry = readdir(directory)) != 0)
+    {
+    const char* name = entry->d_name;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+      {
+      continue;
+      }
+    EntryType type;
+#ifdef DT_DIR
+    if (entry->d_type == DT_REG)
+      {
+      type = FileEntry;
+      }
+    else if (entry->d_type == DT_DIR)
+      {
+      type = DirectoryEntry;
+      }
+    else if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN)
+      {
+      type = statEntry(encodedPath + '/' + name);
+      }
+    else
+      {
+      type = OtherEntry;
+      }
+#else
+    type = statEntry(encodedPath + '/' + name);
+#endif
+    if (type != OtherEntry)
+      {
+      entries << Entry(QFile::decodeName(name), type);
+      }
+    }
+  closedir(directory);
+  return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Wildcard patterns. A QRegExp can't be matched from several threads at
+// once, so every task builds its own matchers.
+class PatternMatcher
+{
+public:
+  PatternMatcher(const QStringList& patterns)
+  {
+    foreach(const QString& pattern, patterns)
+      {
+      Pattern compiled;
+      compiled.Expression = QRegExp(pattern, Qt::CaseSensitive, QRegExp::WildcardUnix);
+      compiled.MatchPath = pattern.contains(QLatin1Char('/'));
+      this->Patterns << compiled;
+      }
+  }
+
+  bool isEmpty()const
+  {
+    return this->Patterns.isEmpty();
+  }
+
+  bool matches(const QString& name, const QString& relativePath)const
+  {
+    foreach(const Pattern& pattern, this->Patterns)
+      {
+      if (pattern.Expression.exactMatch(pattern.MatchPath ? relativePath : name))
+        {
+        return true;
+        }
+      }
+    return false;
+  }
+
+private:
+  class Pattern
+  {
+  public:
+    QRegExp Expression;
+    bool    MatchPath;
+  };
+  QList<Pattern> Patterns;
+};
+
+//-----------------------------------------------------------------------------
+class ScanState
+{
+public:
+  QThreadPool* ThreadPool;
+  QString      Directory;
+  QStringList  IncludePatterns;
+  QStringList  ExcludePatterns;
+  QMutex       Mutex;
+  QStringList  Headers;
+  QStringList  UnreadableDirectories;
+};
+
+bool listDirectory(ScanState* state, const QString& relativePath);
+
+//-----------------------------------------------------------------------------
+class ListDirectoryRunnable : public QRunnable
+{
+public:
+  ListDirectoryRunnable(ScanState* state, const QString& relativePath)
+    : State(state), RelativePath(relativePath) {}
+
+  virtual void run()
+  {
+    if (!listDirectory(this->State, this->RelativePath))
+      {
+      QMutexLocker locker(&this->State->Mutex);
+      this->State->UnreadableDirectories <<
+          this->State->Directory + QLatin1Char('/') + this->RelativePath;
+      }
+  }
+
+  ScanState* State;
+  QString    RelativePath;
+};
+
+//-----------------------------------------------------------------------------
+// Collect the headers of the directory and queue its subdirectories
+bool listDirectory(ScanState* state, const QString& relativePath)
+{
+  QString path = relativePath.isEmpty() ?
+        state->Directory : state->Directory + QLatin1Char('/') + relativePath;
+  QList<Entry> entries;
+  if (!readDirectory(path, entries))
+    {
+    return false;
+    }
+
+  PatternMatcher includes(state->IncludePatterns);
+  PatternMatcher excludes(state->ExcludePatterns);
+  QStringList headers;
+  foreach(const Entry& entry, entries)
+    {
+    const QString& name = entry.first;
+    QString entryRelativePath = relativePath.isEmpty() ?
+          name : relativePath + QLatin1Char('/') + name;
+    if (entry.second == DirectoryEntry)
+      {
+      if (!excludes.matches(name, entryRelativePath))
+        {
+        state->ThreadPool->start(new ListDirectoryRunnable(state, entryRelativePath));
+        }
+      continue;
+      }
+    if (!ctkPythonQtWrapper::isRegularHeader(name)
+        || ctkPythonQtWrapper::isPimplHeader(name)
+        || (!includes.isEmpty() && !includes.matches(name, entryRelativePath))
+        || excludes.matches(name, entryRelativePath))
+      {
+      continue;
+      }
+    headers << state->Directory + QLatin1Char('/') + entryRelativePath;
+    }
+
+  if (!headers.isEmpty())
+    {
+    QMutexLocker locker(&state->Mutex);
+    state->Headers << headers;
+    }
+  return true;
+}
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperDirectoryScanner::ctkPythonQtWrapperDirectoryScanner()
+{
+  this->ThreadPool.setMaxThreadCount(2 * qMax(1, QThread::idealThreadCount()));
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperDirectoryScanner::~ctkPythonQtWrapperDirectoryScanner()
+{
+  this->ThreadPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperDirectoryScanner::threadCount()const
+{
+  return this->ThreadPool.maxThreadCount();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperDirectoryScanner::setThreadCount(int count)
+{
+  this->ThreadPool.setMaxThreadCount(qMax(1, count));
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperDirectoryScanner::includePatterns()const
+{
+  return this->IncludePatterns;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperDirectoryScanner::setIncludePatterns(const QStringList& patterns)
+{
+  this->IncludePatterns = patterns;
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperDirectoryScanner::excludePatterns()const
+{
+  return this->ExcludePatterns;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperDirectoryScanner::setExcludePatterns(const QStringList& patterns)
+{
+  this->ExcludePatterns = patterns;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperDirectoryScanner::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperDirectoryScanner::scan(const QString& directory, QStringList& headers)
+{
+  headers.clear();
+  this->ErrorString.clear();
+  this->UnreadableDirectories.clear();
+
+  ScanState state;
+  state.ThreadPool = &this->ThreadPool;
+  state.Directory = directory;
+  while (state.Directory.size() > 1 && state.Directory.endsWith(QLatin1Char('/')))
+    {
+    state.Directory.chop(1);
+    }
+  state.IncludePatterns = this->IncludePatterns;
+  state.ExcludePatterns = this->ExcludePatterns;
+
+  // The top directory is listed by the calling thread, to report its error
+  bool listed = listDirectory(&state, QString());
+  this->ThreadPool.waitForDone();
+  if (!listed)
+    {
+    this->ErrorString = QString("%1 - Failed to list directory").arg(directory);
+    return false;
+    }
+  headers = state.Headers;
+  headers.sort();
+  this->UnreadableDirectories = state.UnreadableDirectories;
+  this->UnreadableDirectories.sort();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperDirectoryScanner::unreadableDirectories()const
+{
+  return this->UnreadableDirectories;
+}
@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperDirectoryScanner_h
+#define __ctkPythonQtWrapperDirectoryScanner_h
+
+// Qt includes
+#include <QStringList>
+#include <QThreadPool>
+
+/**
+ * Find the headers to wrap below a directory.
+ *
+ * The directories are listed in parallel by a pool of threads, each
+ * directory being a task which queues its subdirectories. Files are
+ * selected from their name only, without being opened nor, where the file
+ * system reports the entry types, stat'ed:
+ * - ctkPythonQtWrapper::isRegularHeader() and isPimplHeader() select the
+ *   regular headers,
+ * - the include patterns, if any, must match the header,
+ * - the exclude patterns must not match the header, nor any of the
+ *   directories it is in, whose content is then not listed.
+ *
+ * Patterns are wildcards (*, ? and [...]). A pattern containing a '/' is
+ * matched against the path relative to the scanned directory, otherwise
+ * against the file or directory name. Symbolic links to directories are not
+ * followed.
+ */
+class ctkPythonQtWrapperDirectoryScanner
+{
+public:
+  ctkPythonQtWrapperDirectoryScanner();
+  ~ctkPythonQtWrapperDirectoryScanner();
+
+  /// Listing is I/O bound, so it defaults to twice the number of cores.
+  /// Tools sharing the machine with other jobs should set it to their
+  /// thread budget.
+  int threadCount()const;
+  void setThreadCount(int count);
+
+  QStringList includePatterns()const;
+  void setIncludePatterns(const QStringList& patterns);
+
+  QStringList excludePatterns()const;
+  void setExcludePatterns(const QStringList& patterns);
+
+  /// Set \a headers to the sorted paths of the headers found below
+  /// \a directory. Unreadable subdirectories are skipped and reported by
+  /// unreadableDirectories(), only an unreadable \a directory is an error.
+  bool scan(const QString& directory, QStringList& headers);
+  QString errorString()const;
+
+  /// Sorted paths of the subdirectories skipped by the last scan() because
+  /// they could not be listed.
+  QStringList unreadableDirectories()const;
+
+private:
+  QThreadPool ThreadPool;
+  QStringList IncludePatterns;
+  QStringList ExcludePatterns;
+  QString     ErrorString;
+  QStringList UnreadableDirectories;
+};
+
+#endif
@@ -0,0 +1,280 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperConfigure.h"
+#include "ctkPythonQtWrapperFileLoader.h"
+
+// STD includes
+#ifdef PythonQtWrapper_USE_IO_URING
+# include <errno.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include <liburing.h>
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+class ReadFileRunnable : public QRunnable
+{
+public:
+  ReadFileRunnable(const QString& filePath, QByteArray* content, bool* loaded)
+    : FilePath(filePath), Content(content), Loaded(loaded) {}
+
+  virtual void run()
+  {
+    QFile file(this->FilePath);
+    if (!file.open(QIODevice::ReadOnly))
+      {
+      *this->Loaded = false;
+      return;
+      }
+    *this->Content = file.readAll();
+    *this->Loaded = file.error() == QFile::NoError;
+  }
+
+  QString     FilePath;
+  QByteArray* Content;
+  bool*       Loaded;
+};
+
+#ifdef PythonQtWrapper_USE_IO_URING
+// Files per io_uring submission. Opening a file takes two entries.
+const int IoUringBatchSize = 64;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperFileLoader::ctkPythonQtWrapperFileLoader()
+{
+  this->ThreadPool.setMaxThreadCount(2 * qMax(1, QThread::idealThreadCount()));
+  this->IoUringDisabled = false;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperFileLoader::~ctkPythonQtWrapperFileLoader()
+{
+  this->ThreadPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperFileLoader::threadCount()const
+{
+  return this->ThreadPool.maxThreadCount();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperFileLoader::setThreadCount(int count)
+{
+  this->ThreadPool.setMaxThreadCount(qMax(1, count));
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperFileLoader::ioUringEnabled()const
+{
+  return !this->IoUringDisabled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperFileLoader::setIoUringEnabled(bool value)
+{
+  this->IoUringDisabled = !value;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperFileLoader::backendName()const
+{
+  return this->BackendName;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperFileLoader::load(const QStringList& filePaths,
+                                        QVector<QByteArray>& contents,
+                                        QVector<bool>& loaded)
+{
+  contents.clear();
+  contents.resize(filePaths.count());
+  loaded.clear();
+  loaded.fill(false, filePaths.count());
+  if (filePaths.isEmpty())
+    {
+    return;
+    }
+
+  this->BackendName = "threads";
+  if (!this->IoUringDisabled && this->loadWithIoUring(filePaths, contents, loaded))
+    {
+    this->BackendName = "io_uring";
+    }
+
+  // Whatever io_uring could not read goes through the thread pool
+  QVector<int> remaining;
+  for (int i = 0; i < filePaths.count(); ++i)
+    {
+    if (!loaded.at(i))
+      {
+      remaining << i;
+      }
+    }
+  if (!remaining.isEmpty())
+    {
+    this->loadWithThreads(filePaths, remaining, contents, loaded);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperFileLoader::loadWithThreads(const QStringList& filePaths,
+                                                   const QVector<int>& indices,
+                                                   QVector<QByteArray>& contents,
+                                                   QVector<bool>& loaded)
+{
+  // Detach before handing out pointers to the elements
+  QByteArray* contentData = contents.data();
+  bool* loadedData = loaded.data();
+  if (indices.count() == 1 || this->ThreadPool.maxThreadCount() == 1)
+    {
+    // A pool thread would only add a hand-over
+    foreach(int i, indices)
+      {
+      ReadFileRunnable(filePaths.at(i), contentData + i, loadedData + i).run();
+      }
+    return;
+    }
+  foreach(int i, indices)
+    {
+    this->ThreadPool.start(new ReadFileRunnable(filePaths.at(i), contentData + i, loadedData + i));
+    }
+  this->ThreadPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperFileLoader::loadWithIoUring(const QStringList& filePaths,
+                                                   QVector<QByteArray>& contents,
+                                                   QVector<bool>& loaded)
+{
+#ifndef PythonQtWrapper_USE_IO_URING
+  Q_UNUSED(filePaths);
+  Q_UNUSED(contents);
+  Q_UNUSED(loaded);
+  this->IoUringDisabled = true;
+  return false;
+#else
+  struct io_uring ring;
+  if (io_uring_queue_init(2 * IoUringBatchSize, &ring, 0) < 0)
+    {
+    // Not supported by the kernel, or forbidden by a seccomp profile
+    this->IoUringDisabled = true;
+    return false;
+    }
+
+  for (int first = 0; first < filePaths.count(); first += IoUringBatchSize)
+    {
+    int count = qMin(IoUringBatchSize, filePaths.count() - first);
+    QVector<QByteArray> paths(count);
+    QVector<int> fds(count, -1);
+    QVector<int> statResults(count, -1);
+    QVector<struct statx> stats(count);
+
+    // Open the files and query their size
+    for (int i = 0; i < count; ++i)
+      {
+      paths[i] = QFile::encodeName(filePaths.at(first + i));
+      struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_openat(sqe, AT_FDCWD, paths.at(i).constData(), O_RDONLY | O_CLOEXEC, 0);
+      sqe->user_data = 2 * i;
+      sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_statx(sqe, AT_FDCWD, paths.at(i).constData(), 0, STATX_SIZE, &stats[i]);
+      sqe->user_data = 2 * i + 1;
+      }
+    io_uring_submit(&ring);
+    for (int n = 0; n < 2 * count; ++n)
+      {
+      struct io_uring_cqe* cqe = 0;
+      if (io_uring_wait_cqe(&ring, &cqe) < 0)
+        {
+        break;
+        }
+      int i = static_cast<int>(cqe->user_data / 2);
+      if (cqe->user_data % 2 == 0)
+        {
+        fds[i] = cqe->res;
+        }
+      else
+        {
+        statResults[i] = cqe->res;
+        }
+      io_uring_cqe_seen(&ring, cqe);
+      }
+
+    // Read them in one go
+    int pendingReads = 0;
+    for (int i = 0; i < count; ++i)
+      {
+      if (fds.at(i) < 0 || statResults.at(i) < 0)
+        {
+        continue;
+        }
+      QByteArray& content = contents[first + i];
+      content.resize(static_cast<int>(stats.at(i).stx_size));
+      if (content.isEmpty())
+        {
+        loaded[first + i] = true;
+        continue;
+        }
+      struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+      io_uring_prep_read(sqe, fds.at(i), content.data(), content.size(), 0);
+      sqe->user_data = i;
+      ++pendingReads;
+      }
+    io_uring_submit(&ring);
+    for (int n = 0; n < pendingReads; ++n)
+      {
+      struct io_uring_cqe* cqe = 0;
+      if (io_uring_wait_cqe(&ring, &cqe) < 0)
+        {
+        break;
+        }
+      int i = static_cast<int>(cqe->user_data);
+      // A short read means the file changed under our feet: let the
+      // fallback read it again.
+      loaded[first + i] = cqe->res == contents.at(first + i).size();
+      io_uring_cqe_seen(&ring, cqe);
+      }
+
+    for (int i = 0; i < count; ++i)
+      {
+      if (fds.at(i) >= 0)
+        {
+        ::close(fds.at(i));
+        }
+      }
+    }
+
+  io_uring_queue_exit(&ring);
+  return true;
+#endif
+}
@@ -0,0 +1,77 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperFileLoader_h
+#define __ctkPythonQtWrapperFileLoader_h
+
+// Qt includes
+#include <QByteArray>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * Read a batch of files with their opens and reads in flight together.
+ *
+ * When built with PythonQtWrapper_USE_IO_URING and running on a kernel that
+ * supports it, the opens, the size queries and then the reads of a batch
+ * are each submitted to io_uring at once. Otherwise, or for the files
+ * io_uring failed to read, the files are read by a pool of threads, so
+ * that the latency of slow or cold file systems is still overlapped.
+ *
+ * A loader must be used from one thread at a time.
+ */
+class ctkPythonQtWrapperFileLoader
+{
+public:
+  ctkPythonQtWrapperFileLoader();
+  ~ctkPythonQtWrapperFileLoader();
+
+  /// Number of threads of the fallback pool. Reading is I/O bound, so it
+  /// defaults to twice the number of cores. With a single thread, the files
+  /// are read by the thread calling load().
+  int threadCount()const;
+  void setThreadCount(int count);
+
+  /// Try io_uring before the thread pool. Enabled by default, it is
+  /// disabled by the first load() if io_uring is not available.
+  bool ioUringEnabled()const;
+  void setIoUringEnabled(bool value);
+
+  /// Read the files of \a filePaths. On return, \a contents and \a loaded
+  /// have one entry per file, \a loaded telling whether it could be read.
+  void load(const QStringList& filePaths,
+            QVector<QByteArray>& contents, QVector<bool>& loaded);
+
+  /// Name of the backend used by the last call to load(), for diagnostics.
+  QString backendName()const;
+
+private:
+  void loadWithThreads(const QStringList& filePaths, const QVector<int>& indices,
+                       QVector<QByteArray>& contents, QVector<bool>& loaded);
+  bool loadWithIoUring(const QStringList& filePaths,
+                       QVector<QByteArray>& contents, QVector<bool>& loaded);
+
+  QThreadPool ThreadPool;
+  bool        IoUringDisabled;
+  QString     BackendName;
+};
+
+#endif
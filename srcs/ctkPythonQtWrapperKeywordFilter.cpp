@@ -0,0 +1,255 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperKeywordFilter.h"
+
+// STD includes
+#include <cstring>
+
+// AVX2 implies SSE2: both are then compiled, and scan() uses AVX2
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define ctkPythonQtWrapper_KEYWORD_FILTER_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define ctkPythonQtWrapper_KEYWORD_FILTER_SSE2
+#endif
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+inline int countTrailingZeros(unsigned int mask)
+{
+#if defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+//-----------------------------------------------------------------------------
+// Return the keyword starting at data[pos], if any, among the wanted ones.
+inline int matchAt(const char* data, int size, int pos, int wanted)
+{
+  const char* p = data + pos;
+  int remaining = size - pos;
+  switch (*p)
+    {
+    case 'Q':
+      if ((wanted & ctkPythonQtWrapperKeywordFilter::QObjectMacro)
+          && remaining >= 8 && std::memcmp(p, "Q_OBJECT", 8) == 0)
+        {
+        return ctkPythonQtWrapperKeywordFilter::QObjectMacro;
+        }
+      break;
+    case 'v':
+      if ((wanted & ctkPythonQtWrapperKeywordFilter::VirtualKeyword)
+          && remaining >= 7 && std::memcmp(p, "virtual", 7) == 0)
+        {
+        return ctkPythonQtWrapperKeywordFilter::VirtualKeyword;
+        }
+      break;
+    case '=':
+      if (wanted & ctkPythonQtWrapperKeywordFilter::PureSpecifier)
+        {
+        int i = 1;
+        while (i < remaining && isSpace(p[i]))
+          {
+          ++i;
+          }
+        if ((i < remaining && p[i] == '0')
+            || (remaining - i >= 4 && std::memcmp(p + i, "NULL", 4) == 0))
+          {
+          return ctkPythonQtWrapperKeywordFilter::PureSpecifier;
+          }
+        }
+      break;
+    default:
+      break;
+    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int scanScalar(const char* data, int size, int pos, int wanted, int found)
+{
+  for (; pos < size && (found & wanted) != wanted; ++pos)
+    {
+    char c = data[pos];
+    if (c == 'Q' || c == 'v' || c == '=')
+      {
+      found |= matchAt(data, size, pos, wanted & ~found);
+      }
+    }
+  return found;
+}
+
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_SSE2)
+//-----------------------------------------------------------------------------
+int scanSse2(const char* data, int size, int wanted)
+{
+  int found = 0;
+  int pos = 0;
+  typedef ctkPythonQtWrapperKeywordFilter Filter;
+  const __m128i q = _mm_set1_epi8('Q');
+  const __m128i v = _mm_set1_epi8('v');
+  const __m128i eq = _mm_set1_epi8('=');
+  for (; pos + 16 <= size && found != wanted; pos += 16)
+    {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i hits = _mm_setzero_si128();
+    if ((wanted & ~found) & Filter::QObjectMacro)
+      {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, q));
+      }
+    if ((wanted & ~found) & Filter::VirtualKeyword)
+      {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, v));
+      }
+    if ((wanted & ~found) & Filter::PureSpecifier)
+      {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, eq));
+      }
+    unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+    while (mask)
+      {
+      found |= matchAt(data, size, pos + countTrailingZeros(mask), wanted & ~found);
+      mask &= mask - 1;
+      }
+    }
+  return scanScalar(data, size, pos, wanted, found);
+}
+#endif
+
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_AVX2)
+//-----------------------------------------------------------------------------
+int scanAvx2(const char* data, int size, int wanted)
+{
+  int found = 0;
+  int pos = 0;
+  typedef ctkPythonQtWrapperKeywordFilter Filter;
+  const __m256i q = _mm256_set1_epi8('Q');
+  const __m256i v = _mm256_set1_epi8('v');
+  const __m256i eq = _mm256_set1_epi8('=');
+  for (; pos + 32 <= size && found != wanted; pos += 32)
+    {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    __m256i hits = _mm256_setzero_si256();
+    if ((wanted & ~found) & Filter::QObjectMacro)
+      {
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, q));
+      }
+    if ((wanted & ~found) & Filter::VirtualKeyword)
+      {
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, v));
+      }
+    if ((wanted & ~found) & Filter::PureSpecifier)
+      {
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, eq));
+      }
+    unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(hits));
+    while (mask)
+      {
+      found |= matchAt(data, size, pos + countTrailingZeros(mask), wanted & ~found);
+      mask &= mask - 1;
+      }
+    }
+  return scanScalar(data, size, pos, wanted, found);
+}
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperKeywordFilter::scan(const char* data, int size, int keywords)
+{
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_AVX2)
+  return scanAvx2(data, size, keywords & AllKeywords);
+#elif defined(ctkPythonQtWrapper_KEYWORD_FILTER_SSE2)
+  return scanSse2(data, size, keywords & AllKeywords);
+#else
+  return scanScalar(data, size, 0, keywords & AllKeywords, 0);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperKeywordFilter::scanWith(Implementation implementation,
+                                              const char* data, int size, int keywords)
+{
+  int wanted = keywords & AllKeywords;
+  switch (implementation)
+    {
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_SSE2)
+    case Sse2Implementation:
+      return scanSse2(data, size, wanted);
+#endif
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_AVX2)
+    case Avx2Implementation:
+      return scanAvx2(data, size, wanted);
+#endif
+    default:
+      return scanScalar(data, size, 0, wanted, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperKeywordFilter::isAvailable(Implementation implementation)
+{
+  switch (implementation)
+    {
+    case ScalarImplementation:
+      return true;
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_SSE2)
+    case Sse2Implementation:
+      return true;
+#endif
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_AVX2)
+    case Avx2Implementation:
+      return true;
+#endif
+    default:
+      return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+const char* ctkPythonQtWrapperKeywordFilter::implementationName()
+{
+#if defined(ctkPythonQtWrapper_KEYWORD_FILTER_AVX2)
+  return "avx2";
+#elif defined(ctkPythonQtWrapper_KEYWORD_FILTER_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
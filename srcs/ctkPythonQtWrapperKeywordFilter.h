@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperKeywordFilter_h
+#define __ctkPythonQtWrapperKeywordFilter_h
+
+// Qt includes
+#include <QByteArray>
+
+/**
+ * Look for the keywords the header analysis depends on, directly in the
+ * raw bytes of a header.
+ *
+ * The search looks for the first character of every keyword at once, 32
+ * (AVX2) or 16 (SSE2) bytes at a time, and only compares the full keyword
+ * where one of them matched. It stops as soon as all the requested keywords
+ * have been seen. Without SIMD support, a scalar loop is used. The scalar
+ * loop also handles the bytes past the last full block.
+ *
+ * This is a prefilter: a keyword being found does not mean the header is
+ * valid, but a header missing Q_OBJECT can be rejected without being
+ * decoded, and the pure virtual method check can be skipped for headers
+ * without "virtual" or "= 0".
+ */
+class ctkPythonQtWrapperKeywordFilter
+{
+public:
+  enum Keyword
+    {
+    QObjectMacro   = 0x1, ///< Q_OBJECT
+    VirtualKeyword = 0x2, ///< virtual
+    PureSpecifier  = 0x4, ///< "=" followed by "0" or "NULL"
+    AllKeywords    = 0x7
+    };
+
+  enum Implementation
+    {
+    ScalarImplementation,
+    Sse2Implementation,
+    Avx2Implementation
+    };
+
+  /// Return the subset of \a keywords found in \a data.
+  static int scan(const char* data, int size, int keywords = AllKeywords);
+  static int scan(const QByteArray& data, int keywords = AllKeywords)
+  {
+    return scan(data.constData(), data.size(), keywords);
+  }
+
+  /// Same as scan(), using the given \a implementation. An implementation
+  /// that was not compiled in falls back to the scalar loop.
+  /// \sa isAvailable()
+  static int scanWith(Implementation implementation,
+                      const char* data, int size, int keywords = AllKeywords);
+
+  /// Return true if \a implementation was compiled in. With AVX2, the SSE2
+  /// implementation is available as well.
+  static bool isAvailable(Implementation implementation);
+
+  /// Name of the implementation selected at compile time.
+  static const char* implementationName();
+};
+
+#endif
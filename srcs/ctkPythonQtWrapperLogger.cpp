@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QMutexLocker>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperLogger.h"
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperLogger::ctkPythonQtWrapperLogger(FILE* stream)
+{
+  this->Stream = stream;
+  this->CurrentLevel = Warning;
+  this->BufferSize = 64 * 1024;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperLogger::~ctkPythonQtWrapperLogger()
+{
+  this->flush();
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperLogger::Level ctkPythonQtWrapperLogger::level()const
+{
+  return this->CurrentLevel;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperLogger::setLevel(Level level)
+{
+  this->CurrentLevel = level;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperLogger::bufferSize()const
+{
+  return this->BufferSize;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperLogger::setBufferSize(int size)
+{
+  this->BufferSize = size;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperLogger::write(Level level, const QString& message)
+{
+  if (!this->isEnabled(level))
+    {
+    return;
+    }
+  QByteArray line = message.toLocal8Bit();
+  QMutexLocker locker(&this->Mutex);
+  this->Buffer.append(line).append('\n');
+  if (level <= Warning || this->Buffer.size() >= this->BufferSize)
+    {
+    this->flushLocked();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperLogger::flush()
+{
+  QMutexLocker locker(&this->Mutex);
+  this->flushLocked();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperLogger::flushLocked()
+{
+  if (this->Buffer.isEmpty())
+    {
+    return;
+    }
+  fwrite(this->Buffer.constData(), 1, this->Buffer.size(), this->Stream);
+  fflush(this->Stream);
+  this->Buffer.clear();
+}
@@ -0,0 +1,111 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperLogger_h
+#define __ctkPythonQtWrapperLogger_h
+
+// Qt includes
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+// STD includes
+#include <cstdio>
+
+/**
+ * Levelled, buffered and thread-safe message sink.
+ *
+ * Messages are appended to an in-memory buffer which is written to the
+ * stream when it grows past bufferSize(), when flush() is called, and on
+ * destruction. Errors and warnings are written immediately, so that they
+ * keep their order with the messages written directly to the stream.
+ * Messages written from several threads never interleave.
+ *
+ * Use the logging macros below rather than write(): they only evaluate
+ * the message expression if its level is enabled, so that disabled
+ * messages cost a single comparison.
+ *
+ * \code
+ * ctkPythonQtWrapperDebugMacro(logger, QString("validate [%1]").arg(filePath));
+ * \endcode
+ */
+class ctkPythonQtWrapperLogger
+{
+public:
+  enum Level
+    {
+    Error = 0,
+    Warning,
+    Info,
+    Debug
+    };
+
+  ctkPythonQtWrapperLogger(FILE* stream = stdout);
+  ~ctkPythonQtWrapperLogger();
+
+  /// Messages more detailed than \a level are discarded. Defaults to Warning.
+  Level level()const;
+  void setLevel(Level level);
+
+  bool isEnabled(Level level)const
+  {
+    return level <= this->CurrentLevel;
+  }
+
+  /// Append \a message followed by a new line.
+  void write(Level level, const QString& message);
+
+  /// Write the buffered messages to the stream.
+  void flush();
+
+  /// Defaults to 64KiB.
+  int bufferSize()const;
+  void setBufferSize(int size);
+
+private:
+  void flushLocked();
+
+  FILE*      Stream;
+  Level      CurrentLevel;
+  int        BufferSize;
+  QMutex     Mutex;
+  QByteArray Buffer;
+};
+
+#define ctkPythonQtWrapperLogMacro(logger, level, message) \
+  do \
+    { \
+    if ((logger).isEnabled(level)) \
+      { \
+      (logger).write(level, message); \
+      } \
+    } \
+  while (0)
+
+#define ctkPythonQtWrapperErrorMacro(logger, message) \
+  ctkPythonQtWrapperLogMacro(logger, ctkPythonQtWrapperLogger::Error, message)
+#define ctkPythonQtWrapperWarningMacro(logger, message) \
+  ctkPythonQtWrapperLogMacro(logger, ctkPythonQtWrapperLogger::Warning, message)
+#define ctkPythonQtWrapperInfoMacro(logger, message) \
+  ctkPythonQtWrapperLogMacro(logger, ctkPythonQtWrapperLogger::Info, message)
+#define ctkPythonQtWrapperDebugMacro(logger, message) \
+  ctkPythonQtWrapperLogMacro(logger, ctkPythonQtWrapperLogger::Debug, message)
+
+#endif
@@ -0,0 +1,634 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QRegExp>
+#include <QSet>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperMembers.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Remove the comments and the preprocessor directives, which would be
+// mistaken for declarations.
+QString stripCommentsAndDirectives(const QString& content)
+{
+  QString text;
+  text.reserve(content.size());
+  int pos = 0;
+  bool lineStart = true;
+  while (pos < content.size())
+    {
+    QChar c = content.at(pos);
+    QChar next = pos + 1 < content.size() ? content.at(pos + 1) : QChar();
+    if (c == QLatin1Char('/') && next == QLatin1Char('/'))
+      {
+      pos = content.indexOf(QLatin1Char('\n'), pos);
+      if (pos < 0)
+        {
+        break;
+        }
+      continue;
+      }
+    if (c == QLatin1Char('/') && next == QLatin1Char('*'))
+      {
+      pos = content.indexOf(QLatin1String("*/"), pos + 2);
+      if (pos < 0)
+        {
+        break;
+        }
+      pos += 2;
+      text += QLatin1Char(' ');
+      continue;
+      }
+    if (lineStart && c == QLatin1Char('#'))
+      {
+      // Skip the directive, including its continuation lines
+      while (pos < content.size() && content.at(pos) != QLatin1Char('\n'))
+        {
+        if (content.at(pos) == QLatin1Char('\\'))
+          {
+          ++pos;
+          }
+        ++pos;
+        }
+      continue;
+      }
+    if (c == QLatin1Char('\n'))
+      {
+      lineStart = true;
+      }
+    else if (!c.isSpace())
+      {
+      lineStart = false;
+      }
+    text += c;
+    ++pos;
+    }
+  return text;
+}
+
+//-----------------------------------------------------------------------------
+// Index of the bracket closing the one at \a open, or -1.
+int matchingBracket(const QString& text, int open)
+{
+  QChar opening = text.at(open);
+  QChar closing = opening == QLatin1Char('(') ? QLatin1Char(')') : QLatin1Char('}');
+  int depth = 0;
+  for (int pos = open; pos < text.size(); ++pos)
+    {
+    if (text.at(pos) == opening)
+      {
+      ++depth;
+      }
+    else if (text.at(pos) == closing && --depth == 0)
+      {
+      return pos;
+      }
+    }
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Split \a text at the commas which are not nested in brackets.
+QStringList splitParameters(const QString& text)
+{
+  QStringList parameters;
+  int depth = 0;
+  int start = 0;
+  for (int pos = 0; pos < text.size(); ++pos)
+    {
+    QChar c = text.at(pos);
+    if (c == QLatin1Char('<') || c == QLatin1Char('('))
+      {
+      ++depth;
+      }
+    else if (c == QLatin1Char('>') || c == QLatin1Char(')'))
+      {
+      --depth;
+      }
+    else if (c == QLatin1Char(',') && depth == 0)
+      {
+      parameters << text.mid(start, pos - start);
+      start = pos + 1;
+      }
+    }
+  parameters << text.mid(start);
+  return parameters;
+}
+
+//-----------------------------------------------------------------------------
+bool isTypeKeyword(const QString& word)
+{
+  static const char* keywords[] =
+    {
+    "bool", "char", "const", "double", "float", "int", "long", "short",
+    "signed", "unsigned", "void", "volatile", 0
+    };
+  for (int i = 0; keywords[i]; ++i)
+    {
+    if (word == QLatin1String(keywords[i]))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Type of a parameter declaration, without its name and default value, or
+// an empty string if it is not supported.
+QString parameterType(const QString& parameter)
+{
+  QString type = parameter;
+  int depth = 0;
+  for (int pos = 0; pos < type.size(); ++pos)
+    {
+    QChar c = type.at(pos);
+    if (c == QLatin1Char('<') || c == QLatin1Char('('))
+      {
+      ++depth;
+      }
+    else if (c == QLatin1Char('>') || c == QLatin1Char(')'))
+      {
+      --depth;
+      }
+    else if (c == QLatin1Char('=') && depth == 0)
+      {
+      type.truncate(pos);
+      break;
+      }
+    }
+  type = type.simplified();
+  if (type.isEmpty() || type.contains(QLatin1Char('(')) || type.contains(QLatin1Char('[')))
+    {
+    return QString();
+    }
+
+  QRegExp reName("(\\w+)$");
+  if (reName.indexIn(type) < 0 || isTypeKeyword(reName.cap(1)))
+    {
+    return type;
+    }
+  QString prefix = type.left(reName.pos(1)).trimmed();
+  if (prefix.isEmpty() || prefix.endsWith(QLatin1String("::")))
+    {
+    return type;
+    }
+  bool onlyQualifiers = true;
+  foreach(const QString& word, prefix.split(QLatin1Char(' ')))
+    {
+    if (!isTypeKeyword(word))
+      {
+      // e.g. "QString text"
+      return prefix;
+      }
+    if (word != QLatin1String("const") && word != QLatin1String("volatile"))
+      {
+      onlyQualifiers = false;
+      }
+    }
+  // "const QString" is unnamed, "unsigned count" is named
+  return onlyQualifiers ? type : prefix;
+}
+
+//-----------------------------------------------------------------------------
+bool hasDefaultValue(const QString& parameter)
+{
+  int depth = 0;
+  for (int pos = 0; pos < parameter.size(); ++pos)
+    {
+    QChar c = parameter.at(pos);
+    if (c == QLatin1Char('<') || c == QLatin1Char('('))
+      {
+      ++depth;
+      }
+    else if (c == QLatin1Char('>') || c == QLatin1Char(')'))
+      {
+      --depth;
+      }
+    else if (c == QLatin1Char('=') && depth == 0)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Prefix the types declared in the class with its name.
+QString qualifyType(const QString& type, const QSet<QString>& nestedTypes,
+                    const QString& className)
+{
+  if (nestedTypes.isEmpty())
+    {
+    return type;
+    }
+  QString qualified;
+  QRegExp reWord("\\w+");
+  int last = 0;
+  int pos = 0;
+  while ((pos = reWord.indexIn(type, pos)) >= 0)
+    {
+    qualified += type.mid(last, pos - last);
+    bool isQualified = pos >= 2 && type.mid(pos - 2, 2) == QLatin1String("::");
+    if (!isQualified && nestedTypes.contains(reWord.cap(0)))
+      {
+      qualified += className;
+      qualified += QLatin1String("::");
+      }
+    qualified += reWord.cap(0);
+    pos += reWord.matchedLength();
+    last = pos;
+    }
+  qualified += type.mid(last);
+  return qualified;
+}
+
+//-----------------------------------------------------------------------------
+// Scanner of the body of a class declaration
+class ClassScanner
+{
+public:
+  ClassScanner() : IsPublic(false), IsSlot(false) {}
+
+  void scan(const QString& text, int pos);
+  void processDeclaration(const QString& statement);
+  void processProperty(const QString& arguments);
+
+  bool                              IsPublic;
+  bool                              IsSlot;
+  QSet<QString>                     NestedTypes;
+  QSet<QString>                     PublicMethodNames;
+  QList<ctkPythonQtWrapperProperty> Properties;
+  QList<ctkPythonQtWrapperMethod>   Methods;
+};
+
+//-----------------------------------------------------------------------------
+void ClassScanner::scan(const QString& text, int pos)
+{
+  // Macros without a trailing semicolon, e.g. Q_OBJECT, may precede the
+  // access specifiers and the macro invocations. Macros are told from
+  // declarations by their upper case name, e.g. CTK_DECLARE_PRIVATE(ctkFoo),
+  // since a declaration has a type and a name.
+  QRegExp reAccess("(?:[A-Z][A-Z0-9_]* )*(public|protected|private|signals|Q_SIGNALS)( (slots|Q_SLOTS))?");
+  QRegExp reMacro("(?:[A-Z][A-Z0-9_]* )*([A-Z][A-Z0-9_]*)");
+  QString statement;
+  while (pos < text.size())
+    {
+    QChar c = text.at(pos);
+    if (c == QLatin1Char('}'))
+      {
+      // End of the class
+      break;
+      }
+    else if (c == QLatin1Char('{'))
+      {
+      // Inline function, or nested type
+      int end = matchingBracket(text, pos);
+      if (end < 0)
+        {
+        break;
+        }
+      this->processDeclaration(statement);
+      statement.clear();
+      pos = end + 1;
+      }
+    else if (c == QLatin1Char('('))
+      {
+      int end = matchingBracket(text, pos);
+      if (end < 0)
+        {
+        break;
+        }
+      if (reMacro.exactMatch(statement.simplified()))
+        {
+        if (reMacro.cap(1) == QLatin1String("Q_PROPERTY"))
+          {
+          this->processProperty(text.mid(pos + 1, end - pos - 1));
+          }
+        statement.clear();
+        }
+      else
+        {
+        statement += text.mid(pos, end - pos + 1);
+        }
+      pos = end + 1;
+      }
+    else if (c == QLatin1Char(';'))
+      {
+      this->processDeclaration(statement);
+      statement.clear();
+      ++pos;
+      }
+    else if (c == QLatin1Char(':') && pos + 1 < text.size() && text.at(pos + 1) == QLatin1Char(':'))
+      {
+      statement += QLatin1String("::");
+      pos += 2;
+      }
+    else if (c == QLatin1Char(':') && reAccess.exactMatch(statement.simplified()))
+      {
+      this->IsPublic = reAccess.cap(1) == QLatin1String("public");
+      this->IsSlot = !reAccess.cap(3).isEmpty();
+      statement.clear();
+      ++pos;
+      }
+    else
+      {
+      statement += c;
+      ++pos;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ClassScanner::processDeclaration(const QString& statement)
+{
+  QString declaration = statement.simplified();
+  bool invokable = false;
+  QRegExp reLeadingMacro("^(Q_[A-Z_]+) ");
+  while (reLeadingMacro.indexIn(declaration) >= 0)
+    {
+    invokable = invokable || reLeadingMacro.cap(1) == QLatin1String("Q_INVOKABLE");
+    declaration.remove(0, reLeadingMacro.matchedLength());
+    }
+  if (declaration.isEmpty())
+    {
+    return;
+    }
+
+  QRegExp reNestedType("^(enum|class|struct|union) (\\w+)");
+  if (reNestedType.indexIn(declaration) >= 0)
+    {
+    this->NestedTypes.insert(reNestedType.cap(2));
+    return;
+    }
+  if (declaration.startsWith(QLatin1String("typedef ")))
+    {
+    QRegExp reName("(\\w+)$");
+    if (reName.indexIn(declaration) >= 0)
+      {
+      this->NestedTypes.insert(reName.cap(1));
+      }
+    return;
+    }
+  if (declaration.startsWith(QLatin1String("friend "))
+      || declaration.startsWith(QLatin1String("using "))
+      || declaration.startsWith(QLatin1String("template")))
+    {
+    return;
+    }
+
+  int open = declaration.indexOf(QLatin1Char('('));
+  if (open < 0)
+    {
+    // Data member
+    return;
+    }
+  int close = matchingBracket(declaration, open);
+  QString head = declaration.left(open).trimmed();
+  QRegExp reName("(\\w+)$");
+  if (close < 0 || reName.indexIn(head) < 0
+      || head.contains(QLatin1String("operator")) || head.contains(QLatin1Char('~')))
+    {
+    return;
+    }
+  QString name = reName.cap(1);
+  QStringList returnTypeWords = head.left(reName.pos(1)).split(QLatin1Char(' '), QString::SkipEmptyParts);
+  while (!returnTypeWords.isEmpty()
+         && (returnTypeWords.first() == QLatin1String("virtual")
+             || returnTypeWords.first() == QLatin1String("inline")
+             || returnTypeWords.first() == QLatin1String("explicit")))
+    {
+    returnTypeWords.removeFirst();
+    }
+  if (returnTypeWords.isEmpty()
+      || returnTypeWords.first() == QLatin1String("static"))
+    {
+    // Constructor, macro or static method
+    return;
+    }
+  if (this->IsPublic)
+    {
+    this->PublicMethodNames.insert(name);
+    }
+  if (!this->IsPublic || !(this->IsSlot || invokable))
+    {
+    return;
+    }
+
+  ctkPythonQtWrapperMethod method;
+  method.Name = name;
+  QString returnType = returnTypeWords.join(QLatin1String(" "));
+  if (returnType.startsWith(QLatin1String("const ")) && returnType.endsWith(QLatin1Char('&')))
+    {
+    // Returned by value by the decorator
+    returnType = returnType.mid(6, returnType.size() - 7).trimmed();
+    }
+  else if (returnType.endsWith(QLatin1Char('&')))
+    {
+    return;
+    }
+  method.ReturnType = returnType;
+
+  QString parameters = declaration.mid(open + 1, close - open - 1).trimmed();
+  if (!parameters.isEmpty() && parameters != QLatin1String("void"))
+    {
+    foreach(const QString& parameter, splitParameters(parameters))
+      {
+      QString type = parameterType(parameter);
+      if (type.isEmpty())
+        {
+        return;
+        }
+      method.ParameterTypes << type;
+      if (hasDefaultValue(parameter))
+        {
+        ++method.DefaultArgumentCount;
+        }
+      }
+    }
+  this->Methods << method;
+}
+
+//-----------------------------------------------------------------------------
+void ClassScanner::processProperty(const QString& arguments)
+{
+  static const char* keywords[] =
+    {
+    "READ", "WRITE", "MEMBER", "RESET", "NOTIFY", "REVISION", "DESIGNABLE",
+    "SCRIPTABLE", "STORED", "USER", "CONSTANT", "FINAL", 0
+    };
+  QStringList words = arguments.simplified().split(QLatin1Char(' '));
+  int firstKeyword = -1;
+  for (int i = 2; i < words.size() && firstKeyword < 0; ++i)
+    {
+    for (int k = 0; keywords[k]; ++k)
+      {
+      if (words.at(i) == QLatin1String(keywords[k]))
+        {
+        firstKeyword = i;
+        break;
+        }
+      }
+    }
+  if (firstKeyword < 0)
+    {
+    return;
+    }
+
+  ctkPythonQtWrapperProperty property;
+  property.Type = QStringList(words.mid(0, firstKeyword - 1)).join(QLatin1String(" "));
+  property.Name = words.at(firstKeyword - 1);
+  for (int i = firstKeyword; i + 1 < words.size(); ++i)
+    {
+    if (words.at(i) == QLatin1String("READ"))
+      {
+      property.Read = words.at(i + 1);
+      }
+    else if (words.at(i) == QLatin1String("WRITE"))
+      {
+      property.Write = words.at(i + 1);
+      }
+    }
+  this->Properties << property;
+}
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperMembers ctkPythonQtWrapperMembers::extract(const QString& content,
+                                                             const QString& className)
+{
+  ctkPythonQtWrapperMembers members;
+
+  QString text = stripCommentsAndDirectives(content);
+  QRegExp reClass(QString("class[\\s\\n]+(\\w+[\\s\\n]+)?%1[\\s\\n]*(:[^;{]*)?\\{").arg(className));
+  if (reClass.indexIn(text) < 0)
+    {
+    return members;
+    }
+  ClassScanner scanner;
+  scanner.scan(text, reClass.pos() + reClass.matchedLength());
+
+  // The types may be declared after being used, and the accessors have
+  // to be public for the decorators to call them
+  foreach(ctkPythonQtWrapperProperty property, scanner.Properties)
+    {
+    property.Type = qualifyType(property.Type, scanner.NestedTypes, className);
+    if (!scanner.PublicMethodNames.contains(property.Read))
+      {
+      property.Read.clear();
+      }
+    if (!scanner.PublicMethodNames.contains(property.Write))
+      {
+      property.Write.clear();
+      }
+    if (!property.Read.isEmpty() || !property.Write.isEmpty())
+      {
+      members.Properties << property;
+      }
+    }
+  foreach(ctkPythonQtWrapperMethod method, scanner.Methods)
+    {
+    method.ReturnType = qualifyType(method.ReturnType, scanner.NestedTypes, className);
+    for (int i = 0; i < method.ParameterTypes.size(); ++i)
+      {
+      method.ParameterTypes[i] = qualifyType(method.ParameterTypes.at(i), scanner.NestedTypes, className);
+      }
+    members.Methods << method;
+    }
+  return members;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperMembers::generateDecoratorCode(const QString& className)const
+{
+  QString code;
+  foreach(const ctkPythonQtWrapperProperty& property, this->Properties)
+    {
+    if (!property.Read.isEmpty())
+      {
+      code += QLatin1String("  ");
+      code += property.Type;
+      code += QLatin1String(" py_get_");
+      code += property.Name;
+      code += QLatin1Char('(');
+      code += className;
+      code += QLatin1String("* theWrappedObject) { return theWrappedObject->");
+      code += property.Read;
+      code += QLatin1String("(); }\n");
+      }
+    if (!property.Write.isEmpty())
+      {
+      code += QLatin1String("  void py_set_");
+      code += property.Name;
+      code += QLatin1Char('(');
+      code += className;
+      code += QLatin1String("* theWrappedObject, ");
+      code += property.Type;
+      code += QLatin1String(" value) { theWrappedObject->");
+      code += property.Write;
+      code += QLatin1String("(value); }\n");
+      }
+    }
+  foreach(const ctkPythonQtWrapperMethod& method, this->Methods)
+    {
+    // One overload per number of arguments, from all of them down to the
+    // ones without default value
+    int minimumCount = method.ParameterTypes.size() - method.DefaultArgumentCount;
+    for (int count = method.ParameterTypes.size(); count >= minimumCount; --count)
+      {
+      QString arguments;
+      code += QLatin1String("  ");
+      code += method.ReturnType;
+      code += QLatin1Char(' ');
+      code += method.Name;
+      code += QLatin1Char('(');
+      code += className;
+      code += QLatin1String("* theWrappedObject");
+      for (int i = 0; i < count; ++i)
+        {
+        QString argument = QString("arg%1").arg(i);
+        code += QLatin1String(", ");
+        code += method.ParameterTypes.at(i);
+        code += QLatin1Char(' ');
+        code += argument;
+        if (i > 0)
+          {
+          arguments += QLatin1String(", ");
+          }
+        arguments += argument;
+        }
+      code += QLatin1String(") { ");
+      if (method.ReturnType != QLatin1String("void"))
+        {
+        code += QLatin1String("return ");
+        }
+      code += QLatin1String("theWrappedObject->");
+      code += method.Name;
+      code += QLatin1Char('(');
+      code += arguments;
+      code += QLatin1String("); }\n");
+      }
+    }
+  return code;
+}
@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperMembers_h
+#define __ctkPythonQtWrapperMembers_h
+
+// Qt includes
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Q_PROPERTY declaration of a wrapped class.
+ */
+class ctkPythonQtWrapperProperty
+{
+public:
+  bool operator==(const ctkPythonQtWrapperProperty& other)const
+  {
+    return this->Type == other.Type && this->Name == other.Name
+        && this->Read == other.Read && this->Write == other.Write;
+  }
+
+  QString Type;
+  QString Name;
+  /// Names of the accessors, empty if missing.
+  QString Read;
+  QString Write;
+};
+
+/**
+ * Public slot or Q_INVOKABLE method of a wrapped class.
+ */
+class ctkPythonQtWrapperMethod
+{
+public:
+  ctkPythonQtWrapperMethod() : DefaultArgumentCount(0) {}
+
+  bool operator==(const ctkPythonQtWrapperMethod& other)const
+  {
+    return this->ReturnType == other.ReturnType && this->Name == other.Name
+        && this->ParameterTypes == other.ParameterTypes
+        && this->DefaultArgumentCount == other.DefaultArgumentCount;
+  }
+
+  QString     ReturnType;
+  QString     Name;
+  QStringList ParameterTypes;
+  /// Number of trailing parameters with a default value.
+  int         DefaultArgumentCount;
+};
+
+/**
+ * Members of a wrapped class exposed to Python, and the decorator slots
+ * calling them directly.
+ *
+ * Without decorators, PythonQt reads properties and calls invokables by
+ * looking them up by name in the QMetaObject and marshalling their values
+ * through QVariant. The decorator slots generated by
+ * generateDecoratorCode() take the object and the arguments with their
+ * C++ types and call the accessor or the method directly:
+ *
+ * \code
+ * int py_get_value(ctkFoo* theWrappedObject) { return theWrappedObject->value(); }
+ * void py_set_value(ctkFoo* theWrappedObject, int value) { theWrappedObject->setValue(value); }
+ * int add(ctkFoo* theWrappedObject, int arg0, int arg1) { return theWrappedObject->add(arg0, arg1); }
+ * \endcode
+ *
+ * Like moc does for the slots and invokables themselves, a method with
+ * default arguments gets one decorator per number of arguments, so that
+ * they can be omitted from Python:
+ *
+ * \code
+ * int add(ctkFoo* theWrappedObject, int arg0) { return theWrappedObject->add(arg0); }
+ * \endcode
+ *
+ * The header is scanned, not parsed: members it can't make sense of, e.g.
+ * taking function pointers or arrays, are skipped. Types declared in the
+ * class are qualified with the class name.
+ */
+class ctkPythonQtWrapperMembers
+{
+public:
+  bool operator==(const ctkPythonQtWrapperMembers& other)const
+  {
+    return this->Properties == other.Properties && this->Methods == other.Methods;
+  }
+
+  bool isEmpty()const
+  {
+    return this->Properties.isEmpty() && this->Methods.isEmpty();
+  }
+
+  /// Scan the declaration of \a className found in \a content.
+  static ctkPythonQtWrapperMembers extract(const QString& content, const QString& className);
+
+  /// Decorator slots for the members, one per line, indented to be part of
+  /// the "public slots:" section of the wrapper class.
+  QString generateDecoratorCode(const QString& className)const;
+
+  /// Properties whose accessors are public.
+  QList<ctkPythonQtWrapperProperty> Properties;
+  QList<ctkPythonQtWrapperMethod>   Methods;
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Allocation hooks feeding ctkPythonQtWrapperMemoryStats.
+//
+// They are part of the executable rather than of ctkPythonQtWrapperCore:
+// replacing the allocation functions is a decision of the program, not of
+// the tools linking against the library.
+//
+// With the GNU C library, malloc() and friends are interposed so that the
+// buffers of QString and QByteArray, which Qt allocates with qMalloc(), are
+// counted as well. Elsewhere, and in static builds where malloc() would
+// clash with the one of the static C library, only the C++ allocation
+// operators are replaced.
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperConfigure.h"
+#include "ctkPythonQtWrapperMemoryStats.h"
+
+// STD includes
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__) && !defined(PythonQtWrapper_BUILD_STATIC)
+
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void  __libc_free(void* ptr);
+
+//-----------------------------------------------------------------------------
+void* malloc(size_t size)
+{
+  if (ctkPythonQtWrapperMemoryStats::isEnabled())
+    {
+    ctkPythonQtWrapperMemoryStats::recordAllocation(size);
+    }
+  return __libc_malloc(size);
+}
+
+//-----------------------------------------------------------------------------
+void* calloc(size_t count, size_t size)
+{
+  if (ctkPythonQtWrapperMemoryStats::isEnabled())
+    {
+    ctkPythonQtWrapperMemoryStats::recordAllocation(count * size);
+    }
+  return __libc_calloc(count, size);
+}
+
+//-----------------------------------------------------------------------------
+void* realloc(void* ptr, size_t size)
+{
+  if (ctkPythonQtWrapperMemoryStats::isEnabled())
+    {
+    ctkPythonQtWrapperMemoryStats::recordAllocation(size);
+    }
+  return __libc_realloc(ptr, size);
+}
+
+//-----------------------------------------------------------------------------
+void free(void* ptr)
+{
+  __libc_free(ptr);
+}
+}
+
+#else
+
+// Dynamic exception specifications are deprecated by C++11 and removed by
+// C++17
+#if __cplusplus >= 201103L
+# define PythonQtWrapper_THROW_BAD_ALLOC noexcept(false)
+# define PythonQtWrapper_NOTHROW noexcept
+#else
+# define PythonQtWrapper_THROW_BAD_ALLOC throw(std::bad_alloc)
+# define PythonQtWrapper_NOTHROW throw()
+#endif
+
+//-----------------------------------------------------------------------------
+void* operator new(std::size_t size) PythonQtWrapper_THROW_BAD_ALLOC
+{
+  if (ctkPythonQtWrapperMemoryStats::isEnabled())
+    {
+    ctkPythonQtWrapperMemoryStats::recordAllocation(size);
+    }
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+    {
+    throw std::bad_alloc();
+    }
+  return ptr;
+}
+
+//-----------------------------------------------------------------------------
+void* operator new[](std::size_t size) PythonQtWrapper_THROW_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+//-----------------------------------------------------------------------------
+void* operator new(std::size_t size, const std::nothrow_t&) PythonQtWrapper_NOTHROW
+{
+  if (ctkPythonQtWrapperMemoryStats::isEnabled())
+    {
+    ctkPythonQtWrapperMemoryStats::recordAllocation(size);
+    }
+  return std::malloc(size ? size : 1);
+}
+
+//-----------------------------------------------------------------------------
+void* operator new[](std::size_t size, const std::nothrow_t& tag) PythonQtWrapper_NOTHROW
+{
+  return operator new(size, tag);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* ptr) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* ptr) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* ptr, const std::nothrow_t&) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* ptr, const std::nothrow_t&) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+//-----------------------------------------------------------------------------
+void operator delete(void* ptr, std::size_t) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* ptr, std::size_t) PythonQtWrapper_NOTHROW
+{
+  std::free(ptr);
+}
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperConfigure.h"
+#include "ctkPythonQtWrapperMemoryStats.h"
+
+#if defined(_WIN32)
+# include <windows.h>
+# include <psapi.h>
+#else
+# include <sys/resource.h>
+#endif
+
+namespace
+{
+// Plain integers updated with atomic builtins: QAtomicInt is only 32 bits
+// wide, and the counters must not allocate.
+volatile qint64 AllocationCounter = 0;
+volatile qint64 AllocatedBytesCounter = 0;
+
+//-----------------------------------------------------------------------------
+inline void atomicAdd(volatile qint64* counter, qint64 value)
+{
+#if defined(_MSC_VER)
+  InterlockedExchangeAdd64(counter, value);
+#else
+  __sync_fetch_and_add(counter, value);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+inline qint64 atomicLoad(volatile qint64* counter)
+{
+#if defined(_MSC_VER)
+  return InterlockedCompareExchange64(counter, 0, 0);
+#else
+  return __sync_fetch_and_add(counter, 0);
+#endif
+}
+}
+
+QBasicAtomicInt ctkPythonQtWrapperMemoryStats::Enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperMemoryStats::ctkPythonQtWrapperMemoryStats()
+{
+  this->PhaseAllocationCount = allocationCount();
+  this->PhaseAllocatedBytes = allocatedBytes();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperMemoryStats::setEnabled(bool value)
+{
+  Enabled.fetchAndStoreOrdered(value ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperMemoryStats::hooksAvailable()
+{
+#ifdef PythonQtWrapper_USE_MEMORY_HOOKS
+  return true;
+#else
+  return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperMemoryStats::recordAllocation(std::size_t size)
+{
+  atomicAdd(&AllocationCounter, 1);
+  atomicAdd(&AllocatedBytesCounter, static_cast<qint64>(size));
+}
+
+//-----------------------------------------------------------------------------
+qint64 ctkPythonQtWrapperMemoryStats::allocationCount()
+{
+  return atomicLoad(&AllocationCounter);
+}
+
+//-----------------------------------------------------------------------------
+qint64 ctkPythonQtWrapperMemoryStats::allocatedBytes()
+{
+  return atomicLoad(&AllocatedBytesCounter);
+}
+
+//-----------------------------------------------------------------------------
+qint64 ctkPythonQtWrapperMemoryStats::peakResidentSetSize()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+    return 0;
+    }
+  return static_cast<qint64>(counters.PeakWorkingSetSize);
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+    return 0;
+    }
+# if defined(__APPLE__)
+  // Bytes on Mac OS X, kilobytes elsewhere
+  return static_cast<qint64>(usage.ru_maxrss);
+# else
+  return static_cast<qint64>(usage.ru_maxrss) * 1024;
+# endif
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperMemoryStats::endPhase(const QString& name)
+{
+  qint64 count = allocationCount();
+  qint64 bytes = allocatedBytes();
+
+  Phase phase;
+  phase.Name = name;
+  phase.AllocationCount = count - this->PhaseAllocationCount;
+  phase.AllocatedBytes = bytes - this->PhaseAllocatedBytes;
+  phase.PeakResidentBytes = peakResidentSetSize();
+  this->Phases << phase;
+
+  // Don't count the bookkeeping above in the next phase
+  this->PhaseAllocationCount = allocationCount();
+  this->PhaseAllocatedBytes = allocatedBytes();
+}
+
+//-----------------------------------------------------------------------------
+const QList<ctkPythonQtWrapperMemoryStats::Phase>& ctkPythonQtWrapperMemoryStats::phases()const
+{
+  return this->Phases;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperMemoryStats::report(FILE* stream)const
+{
+  bool counted = hooksAvailable() && isEnabled();
+  foreach(const Phase& phase, this->Phases)
+    {
+    if (counted)
+      {
+      fprintf(stream, "memstats\t%s\t%lld\t%lld\t%lld\n", qPrintable(phase.Name),
+              static_cast<long long>(phase.AllocationCount),
+              static_cast<long long>(phase.AllocatedBytes),
+              static_cast<long long>(phase.PeakResidentBytes));
+      }
+    else
+      {
+      fprintf(stream, "memstats\t%s\t-\t-\t%lld\n", qPrintable(phase.Name),
+              static_cast<long long>(phase.PeakResidentBytes));
+      }
+    }
+  fflush(stream);
+}
@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperMemoryStats_h
+#define __ctkPythonQtWrapperMemoryStats_h
+
+// Qt includes
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+// STD includes
+#include <cstddef>
+#include <cstdio>
+
+/**
+ * Allocation counters and peak resident set size, reported per phase.
+ *
+ * The counters are fed by the allocation hooks compiled in the executable
+ * when PythonQtWrapper_USE_MEMORY_HOOKS is enabled. The hooks only test
+ * isEnabled() before forwarding to the C library, so that the counters cost
+ * a single predictable branch per allocation until setEnabled() is called.
+ *
+ * \code
+ * ctkPythonQtWrapperMemoryStats::setEnabled(true);
+ * ctkPythonQtWrapperMemoryStats stats;
+ * wrapper.validateInputFiles();
+ * stats.endPhase("validate");
+ * stats.report(stderr);
+ * \endcode
+ */
+class ctkPythonQtWrapperMemoryStats
+{
+public:
+  class Phase
+  {
+  public:
+    Phase() : AllocationCount(0), AllocatedBytes(0), PeakResidentBytes(0) {}
+    QString Name;
+    qint64  AllocationCount;
+    qint64  AllocatedBytes;
+    /// Peak resident set size of the process at the end of the phase.
+    qint64  PeakResidentBytes;
+  };
+
+  /// The first phase starts on construction.
+  ctkPythonQtWrapperMemoryStats();
+
+  static bool isEnabled()
+  {
+    return Enabled != 0;
+  }
+  static void setEnabled(bool value);
+
+  /// True if the allocation hooks are compiled in. Otherwise only the
+  /// resident set size is reported.
+  static bool hooksAvailable();
+
+  /// Called by the allocation hooks, must not allocate.
+  static void recordAllocation(std::size_t size);
+
+  static qint64 allocationCount();
+  static qint64 allocatedBytes();
+
+  /// Peak resident set size of the process, in bytes, or 0 if unknown.
+  static qint64 peakResidentSetSize();
+
+  /// Close the current phase under \a name and start the next one.
+  void endPhase(const QString& name);
+  const QList<Phase>& phases()const;
+
+  /// Write one tab separated line per phase: name, allocation count,
+  /// allocated bytes and peak resident set size in bytes.
+  void report(FILE* stream)const;
+
+private:
+  /// Read by the allocation hooks of every thread. A QBasicAtomicInt is
+  /// initialized statically, before the first allocation.
+  static QBasicAtomicInt Enabled;
+
+  QList<Phase> Phases;
+  qint64       PhaseAllocationCount;
+  qint64       PhaseAllocatedBytes;
+};
+
+#endif
@@ -0,0 +1,436 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QHash>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperModule.h"
+#include "ctkPythonQtWrapperVersion.h"
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperModule::ctkPythonQtWrapperModule()
+{
+  this->ExportMacro = "PythonQtWrapper_INIT_EXPORT";
+  this->UnityBuild = false;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperModule::~ctkPythonQtWrapperModule()
+{
+  qDeleteAll(this->Targets);
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::lastError()const
+{
+  return this->LastError;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::wrappingNamespace()const
+{
+  return this->WrappingNamespace;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::wrappingNamespaceUnderscore()const
+{
+  QString newWrappingNamespaceUnderscore = this->WrappingNamespace;
+  return newWrappingNamespaceUnderscore.replace(".", "_");
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperModule::setWrappingNamespace(const QString& newWrappingNamespace)
+{
+  this->WrappingNamespace = newWrappingNamespace;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::name()const
+{
+  return this->Name;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperModule::setName(const QString& newName)
+{
+  this->Name = newName;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::exportMacro()const
+{
+  return this->ExportMacro;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperModule::setExportMacro(const QString& newExportMacro)
+{
+  this->ExportMacro = newExportMacro;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::exportHeader()const
+{
+  return this->ExportHeader;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperModule::setExportHeader(const QString& newExportHeader)
+{
+  this->ExportHeader = newExportHeader;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::unityBuild()const
+{
+  return this->UnityBuild;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperModule::setUnityBuild(bool value)
+{
+  this->UnityBuild = value;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::setOutput(const QString& outputDir)
+{
+  this->OutputDir = outputDir;
+  foreach(ctkPythonQtWrapper* target, this->Targets)
+    {
+    target->setOutput(outputDir);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapper* ctkPythonQtWrapperModule::addTarget(const QString& wrappingNamespace,
+                                                        const QString& targetName)
+{
+  ctkPythonQtWrapper* target = new ctkPythonQtWrapper;
+  target->setWrappingNamespace(wrappingNamespace);
+  target->setTargetName(targetName);
+  // Only the module entry point is exported
+  target->setExportMacro("PythonQtWrapper_HIDDEN");
+  target->setOutput(this->OutputDir);
+  this->Targets << target;
+  return target;
+}
+
+//-----------------------------------------------------------------------------
+const QList<ctkPythonQtWrapper*>& ctkPythonQtWrapperModule::targets()const
+{
+  return this->Targets;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::readManifest(const QString& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+    this->LastError = QString("%1 - Failed to open file").arg(filePath);
+    return false;
+    }
+  QTextStream stream(&file);
+  int lineNumber = 0;
+  while (!stream.atEnd())
+    {
+    QString line = stream.readLine().trimmed();
+    ++lineNumber;
+    if (line.isEmpty() || line.startsWith('#'))
+      {
+      continue;
+      }
+    QStringList fields = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    if (fields.count() < 3)
+      {
+      this->LastError = QString("%1:%2 - Expected <wrapping-namespace> <target-name> "
+                                "<header> [<header> ...]").arg(filePath).arg(lineNumber);
+      return false;
+      }
+    ctkPythonQtWrapper* target = this->addTarget(fields.at(0), fields.at(1));
+    if (!target->setInput(fields.mid(2)))
+      {
+      this->LastError = QString("%1:%2 - %3").arg(filePath).arg(lineNumber).arg(target->lastError());
+      return false;
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperModule::validateInputFiles()
+{
+  int rejectedCount = 0;
+  foreach(ctkPythonQtWrapper* target, this->Targets)
+    {
+    rejectedCount += target->validateInputFiles();
+    }
+  return rejectedCount;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::outputDirectoryName()const
+{
+  return QString("generated_cpp/%1_%2").arg(this->wrappingNamespaceUnderscore(), this->Name);
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::initFileName()const
+{
+  return QString("%1_%2_init.cpp").arg(this->wrappingNamespaceUnderscore(), this->Name);
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::headerFileName()const
+{
+  return QString("%1_%2").arg(this->wrappingNamespaceUnderscore(), this->Name) + "0.h";
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::generateHeaderCode()const
+{
+  QString guard = this->wrappingNamespaceUnderscore() + QLatin1Char('_') + this->Name
+      + QLatin1String("0_h");
+
+  QString code;
+  code += QLatin1String("//\n// File auto-generated by PythonQtWrapper " PythonQtWrapper_VERSION "\n//\n\n");
+  code += QLatin1String("#ifndef __");
+  code += guard;
+  code += QLatin1String("\n#define __");
+  code += guard;
+  code += QLatin1String("\n");
+  code += ctkPythonQtWrapper::headerPrologueCode();
+  foreach(const ctkPythonQtWrapper* target, this->Targets)
+    {
+    code += QLatin1String("//=============================================================================\n// ");
+    code += target->wrappingNamespace();
+    code += QLatin1Char(' ');
+    code += target->targetName();
+    code += QLatin1String("\n\n");
+    code += target->generateHeaderBodyCode();
+    }
+  code += QLatin1String("#endif\n");
+  return code;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperModule::generateInitCode()const
+{
+  // Group the targets by wrapping namespace, in order of appearance
+  QStringList wrappingNamespaces;
+  QMap<QString, QStringList> initFunctions;
+  foreach(const ctkPythonQtWrapper* target, this->Targets)
+    {
+    if (!initFunctions.contains(target->wrappingNamespace()))
+      {
+      wrappingNamespaces << target->wrappingNamespace();
+      }
+    initFunctions[target->wrappingNamespace()] << QString("PythonQt_init_%1_%2")
+        .arg(target->wrappingNamespaceUnderscore(), target->targetName());
+    }
+
+  QString code;
+  code += QLatin1String("//\n// File auto-generated by PythonQtWrapper " PythonQtWrapper_VERSION "\n//\n\n");
+  code += QLatin1String("#include <PythonQt.h>\n");
+  if (!this->ExportHeader.isEmpty())
+    {
+    code += QLatin1String("#include \"");
+    code += this->ExportHeader;
+    code += QLatin1String("\"\n");
+    }
+  if (this->UnityBuild)
+    {
+    code += QLatin1String("#include \"");
+    code += this->headerFileName();
+    code += QLatin1String("\"\n");
+    }
+  code += QLatin1String("\n#include <cstring>\n\n");
+  code += ctkPythonQtWrapper::hiddenMacroDefinition();
+  code += QLatin1Char('\n');
+  code += ctkPythonQtWrapper::exportMacroDefinition(this->ExportMacro);
+  code += QLatin1Char('\n');
+  if (this->UnityBuild)
+    {
+    foreach(const ctkPythonQtWrapper* target, this->Targets)
+      {
+      code += QLatin1String("//=============================================================================\n// ");
+      code += target->wrappingNamespace();
+      code += QLatin1Char(' ');
+      code += target->targetName();
+      code += QLatin1String("\n\n");
+      code += target->generateInitBodyCode();
+      code += QLatin1Char('\n');
+      }
+    code += QLatin1String("//=============================================================================\n");
+    }
+  foreach(const QString& wrappingNamespace, wrappingNamespaces)
+    {
+    foreach(const QString& initFunction, initFunctions.value(wrappingNamespace))
+      {
+      code += QLatin1String("PythonQtWrapper_HIDDEN void ");
+      code += initFunction;
+      code += QLatin1String("(PyObject* module);\n");
+      }
+    }
+  code += QLatin1Char('\n');
+  code += this->ExportMacro;
+  code += QLatin1String(" void PythonQt_init_");
+  code += this->wrappingNamespaceUnderscore();
+  code += QLatin1Char('_');
+  code += this->Name;
+  code += QLatin1String("(PyObject* module, const char* wrappingNamespace)\n{\n");
+  foreach(const QString& wrappingNamespace, wrappingNamespaces)
+    {
+    code += QLatin1String("  if (!wrappingNamespace || std::strcmp(wrappingNamespace, \"");
+    code += wrappingNamespace;
+    code += QLatin1String("\") == 0)\n    {\n");
+    foreach(const QString& initFunction, initFunctions.value(wrappingNamespace))
+      {
+      code += QLatin1String("    ");
+      code += initFunction;
+      code += QLatin1String("(module);\n");
+      }
+    code += QLatin1String("    }\n");
+    }
+  code += QLatin1String("}\n");
+  return code;
+}
+
+//-----------------------------------------------------------------------------
+QMap<QString, QByteArray> ctkPythonQtWrapperModule::generateOutputBuffers()
+{
+  QMap<QString, QByteArray> outputs;
+  if (this->UnityBuild)
+    {
+    foreach(ctkPythonQtWrapper* target, this->Targets)
+      {
+      if (target->analyses().count() != target->inputFiles().count())
+        {
+        target->validateInputFiles();
+        }
+      }
+    if (!this->checkUnityClasses())
+      {
+      return outputs;
+      }
+    outputs.insert(this->outputDirectoryName() + "/" + this->headerFileName(),
+                   this->generateHeaderCode().toLocal8Bit());
+    outputs.insert(this->outputDirectoryName() + "/" + this->initFileName(),
+                   this->generateInitCode().toLocal8Bit());
+    return outputs;
+    }
+
+  foreach(ctkPythonQtWrapper* target, this->Targets)
+    {
+    QMap<QString, QByteArray> targetOutputs = target->generateOutputBuffers();
+    QMapIterator<QString, QByteArray> it(targetOutputs);
+    while (it.hasNext())
+      {
+      it.next();
+      outputs.insert(it.key(), it.value());
+      }
+    }
+  outputs.insert(this->outputDirectoryName() + "/" + this->initFileName(),
+                 this->generateInitCode().toLocal8Bit());
+  return outputs;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::checkUnityClasses()
+{
+  // Classes owned by another target in the registry are only referenced
+  QHash<QString, const ctkPythonQtWrapper*> wrappers;
+  QStringList duplicates;
+  foreach(const ctkPythonQtWrapper* target, this->Targets)
+    {
+    foreach(const ctkPythonQtWrapperAnalysis& analysis, target->analyses())
+      {
+      if (!analysis.Valid || target->externalClasses().contains(analysis.ClassName))
+        {
+        continue;
+        }
+      const ctkPythonQtWrapper* first = wrappers.value(analysis.ClassName);
+      if (!first)
+        {
+        wrappers.insert(analysis.ClassName, target);
+        continue;
+        }
+      duplicates << QString("%1 (%2 %3 and %4 %5)").arg(analysis.ClassName,
+        first->wrappingNamespace(), first->targetName(),
+        target->wrappingNamespace(), target->targetName());
+      }
+    }
+  if (!duplicates.isEmpty())
+    {
+    this->LastError = QString("%1 - Classes wrapped by more than one target, which a unity "
+                              "build would define twice: %2. List each header in a single "
+                              "target, or share a registry between the targets.")
+        .arg(this->Name, duplicates.join(", "));
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::writeOutputBuffers(const QMap<QString, QByteArray>& outputs)
+{
+  if (this->Targets.isEmpty())
+    {
+    this->LastError = QString("%1 - Module has no target").arg(this->Name);
+    return false;
+    }
+  // All the targets share the output directory, any of them can write the
+  // module files.
+  ctkPythonQtWrapper* writer = this->Targets.first();
+  if (!writer->writeOutputBuffers(outputs))
+    {
+    this->LastError = writer->lastError();
+    return false;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperModule::generateOutputs()
+{
+  foreach(ctkPythonQtWrapper* target, this->Targets)
+    {
+    if (!target->registryFile().isEmpty() && !target->updateRegistry())
+      {
+      this->LastError = target->lastError();
+      return false;
+      }
+    }
+  QMap<QString, QByteArray> outputs = this->generateOutputBuffers();
+  if (outputs.isEmpty())
+    {
+    return false;
+    }
+  return this->writeOutputBuffers(outputs);
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperModule_h
+#define __ctkPythonQtWrapperModule_h
+
+// Qt includes
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+class ctkPythonQtWrapper;
+
+/**
+ * Several wrapped targets merged into a single module.
+ *
+ * Each target is generated as usual, and the module adds an init file
+ * defining a single entry point registering the targets of a given
+ * wrapping namespace:
+ *
+ * \code
+ * void PythonQt_init_<ns>_<name>(PyObject* module, const char* wrappingNamespace);
+ * \endcode
+ *
+ * A null \a wrappingNamespace registers every target. Building the
+ * generated sources of all the targets into one library avoids loading,
+ * and relocating, one library per target at start-up.
+ *
+ * With a unity build, the targets are not generated separately: their
+ * wrapper classes are concatenated into a single module header, and their
+ * init functions into the module init file. The Qt and PythonQt headers are
+ * then compiled, and the wrapper classes moc'ed, once for the module
+ * instead of once per target. A class can then be wrapped by a single
+ * target, unless the targets share a registry.
+ *
+ * Targets can be added programmatically or read from a manifest file
+ * listing one target per line:
+ *
+ * \code
+ * # <wrapping-namespace> <target-name> <header> [<header> ...]
+ * org.commontk.foo ctkFoo /path/to/ctkFooWidget.h /path/to/ctkFooObject.h
+ * \endcode
+ */
+class ctkPythonQtWrapperModule
+{
+public:
+  ctkPythonQtWrapperModule();
+  ~ctkPythonQtWrapperModule();
+
+  /// Description of the last failure.
+  QString lastError()const;
+
+  /// Namespace and name of the module entry point.
+  QString wrappingNamespace()const;
+  QString wrappingNamespaceUnderscore()const;
+  void setWrappingNamespace(const QString& newWrappingNamespace);
+
+  QString name()const;
+  void setName(const QString& newName);
+
+  /// Visibility of the module entry point, see
+  /// ctkPythonQtWrapper::setExportMacro(). The init functions of the
+  /// targets are hidden.
+  QString exportMacro()const;
+  void setExportMacro(const QString& newExportMacro);
+  QString exportHeader()const;
+  void setExportHeader(const QString& newExportHeader);
+
+  /// Generate the module header and init file only. Disabled by default.
+  bool unityBuild()const;
+  void setUnityBuild(bool value);
+
+  /// Output directory of the module and of its targets.
+  bool setOutput(const QString& outputDir);
+
+  /// Add a target whose inputs still have to be set. The target is owned
+  /// by the module.
+  ctkPythonQtWrapper* addTarget(const QString& wrappingNamespace, const QString& targetName);
+  const QList<ctkPythonQtWrapper*>& targets()const;
+
+  /// Add the targets listed in the manifest file \a filePath.
+  bool readManifest(const QString& filePath);
+
+  /// Validate the inputs of every target and return the number of
+  /// rejected headers.
+  int validateInputFiles();
+
+  /// Directory, relative to the output directory, of the module init file.
+  QString outputDirectoryName()const;
+  QString initFileName()const;
+  /// Header of a unity build, in the same directory.
+  QString headerFileName()const;
+
+  QString generateInitCode()const;
+  QString generateHeaderCode()const;
+
+  /// Sources of the targets and of the module, keyed by their path
+  /// relative to the output directory. Empty if a unity build would wrap a
+  /// class twice, see lastError().
+  QMap<QString, QByteArray> generateOutputBuffers();
+  bool writeOutputBuffers(const QMap<QString, QByteArray>& outputs);
+  bool generateOutputs();
+
+private:
+  /// Return false and set LastError if several targets wrap the same class.
+  bool checkUnityClasses();
+
+  QList<ctkPythonQtWrapper*> Targets;
+  QString     OutputDir;
+  QString     LastError;
+  QString     WrappingNamespace;
+  QString     Name;
+  QString     ExportMacro;
+  QString     ExportHeader;
+  bool        UnityBuild;
+};
+
+#endif
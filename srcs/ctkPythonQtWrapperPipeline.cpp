@@ -0,0 +1,319 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperFileLoader.h"
+#include "ctkPythonQtWrapperKeywordFilter.h"
+#include "ctkPythonQtWrapperPipeline.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+class PipelineItem
+{
+public:
+  PipelineItem()
+    : Index(-1), Loaded(false), Keywords(ctkPythonQtWrapperKeywordFilter::AllKeywords) {}
+
+  int     Index;
+  QString FilePath;
+  QString Content;
+  bool    Loaded;
+  QString ErrorString;
+  /// Keywords found by ctkPythonQtWrapperKeywordFilter
+  int     Keywords;
+};
+
+//-----------------------------------------------------------------------------
+template <typename T>
+class BoundedQueue
+{
+public:
+  BoundedQueue(int capacity) : Capacity(capacity) {}
+
+  void push(const T& item)
+  {
+    QMutexLocker locker(&this->Mutex);
+    while (this->Items.size() >= this->Capacity)
+      {
+      this->NotFull.wait(&this->Mutex);
+      }
+    this->Items.enqueue(item);
+    this->NotEmpty.wakeOne();
+  }
+
+  T pop()
+  {
+    QMutexLocker locker(&this->Mutex);
+    while (this->Items.isEmpty())
+      {
+      this->NotEmpty.wait(&this->Mutex);
+      }
+    T item = this->Items.dequeue();
+    this->NotFull.wakeOne();
+    return item;
+  }
+
+private:
+  int            Capacity;
+  QQueue<T>      Items;
+  QMutex         Mutex;
+  QWaitCondition NotEmpty;
+  QWaitCondition NotFull;
+};
+
+//-----------------------------------------------------------------------------
+class PipelineState
+{
+public:
+  PipelineState(const ctkPythonQtWrapper* wrapper, int analyserCount, int windowSize)
+    : Wrapper(wrapper), LoadedItems(windowSize + analyserCount)
+  {}
+
+  const ctkPythonQtWrapper* Wrapper;
+  /// Room for the whole window and the end-of-stream markers, so that the
+  /// calling thread never blocks on it.
+  BoundedQueue<PipelineItem> LoadedItems;
+
+  QMutex                                ResultsMutex;
+  QWaitCondition                        ResultAvailable;
+  QMap<int, ctkPythonQtWrapperAnalysis> Results;
+};
+
+//-----------------------------------------------------------------------------
+QList<PipelineItem> loadBatch(const ctkPythonQtWrapper* wrapper,
+                              ctkPythonQtWrapperFileLoader* loader,
+                              const QStringList& filePaths, int first, int count)
+{
+  QList<PipelineItem> items;
+  QStringList filesToRead;
+  QVector<int> itemsToRead;
+  for (int i = first; i < first + count; ++i)
+    {
+    PipelineItem item;
+    item.Index = i;
+    item.FilePath = filePaths.at(i);
+    // Headers rejected because of their name are not worth reading
+    item.Loaded = !wrapper->isRegularHeader(item.FilePath)
+               || wrapper->isPimplHeader(item.FilePath)
+               || wrapper->inputBuffer(item.FilePath, item.Content);
+    if (!item.Loaded)
+      {
+      filesToRead << item.FilePath;
+      itemsToRead << items.count();
+      }
+    items << item;
+    }
+
+  QVector<QByteArray> contents;
+  QVector<bool> loaded;
+  loader->load(filesToRead, contents, loaded);
+  for (int i = 0; i < itemsToRead.count(); ++i)
+    {
+    PipelineItem& item = items[itemsToRead.at(i)];
+    item.Loaded = loaded.at(i);
+    if (item.Loaded)
+      {
+      // Most headers are not QObjects: reject them before decoding
+      item.Keywords = ctkPythonQtWrapperKeywordFilter::scan(contents.at(i));
+      if (item.Keywords & ctkPythonQtWrapperKeywordFilter::QObjectMacro)
+        {
+        item.Content = wrapper->decodeInput(contents.at(i));
+        }
+      }
+    else
+      {
+      item.ErrorString = QString("%1 - Failed to open file").arg(item.FilePath);
+      }
+    }
+  return items;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperAnalysis analyze(const ctkPythonQtWrapper* wrapper, const PipelineItem& item)
+{
+  if (!item.Loaded)
+    {
+    ctkPythonQtWrapperAnalysis analysis;
+    analysis.FilePath = item.FilePath;
+    analysis.ClassName = QFileInfo(item.FilePath).completeBaseName();
+    analysis.Reason = "Failed to open file";
+    analysis.ErrorString = item.ErrorString;
+    return analysis;
+    }
+  return wrapper->analyze(item.FilePath, item.Content, item.Keywords);
+}
+
+//-----------------------------------------------------------------------------
+class AnalyserThread : public QThread
+{
+public:
+  AnalyserThread(PipelineState* state) : State(state) {}
+
+protected:
+  virtual void run()
+  {
+    forever
+      {
+      PipelineItem item = this->State->LoadedItems.pop();
+      if (item.Index < 0)
+        {
+        break;
+        }
+      ctkPythonQtWrapperAnalysis analysis = analyze(this->State->Wrapper, item);
+      item.Content.clear();
+
+      QMutexLocker locker(&this->State->ResultsMutex);
+      this->State->Results.insert(item.Index, analysis);
+      this->State->ResultAvailable.wakeAll();
+      }
+  }
+
+  PipelineState* State;
+};
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperPipeline::ctkPythonQtWrapperPipeline(const ctkPythonQtWrapper* wrapper)
+{
+  this->Wrapper = wrapper;
+  this->AnalyserCount = 0;
+  this->WindowSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperPipeline::analyserCount()const
+{
+  return this->AnalyserCount;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperPipeline::setAnalyserCount(int count)
+{
+  this->AnalyserCount = qMax(0, count);
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperPipeline::windowSize()const
+{
+  if (this->WindowSize > 0)
+    {
+    return this->WindowSize;
+    }
+  return qMax(16, 4 * this->AnalyserCount);
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperPipeline::setWindowSize(int size)
+{
+  this->WindowSize = size;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperPipeline::run(const QStringList& filePaths, Consumer* consumer)
+{
+  if (this->AnalyserCount == 0 || filePaths.count() < 2)
+    {
+    ctkPythonQtWrapperFileLoader loader;
+    loader.setThreadCount(this->Wrapper->maximumThreadCount());
+    int batchSize = this->windowSize();
+    for (int first = 0; first < filePaths.count(); first += batchSize)
+      {
+      int count = qMin(batchSize, filePaths.count() - first);
+      foreach(const PipelineItem& item,
+              loadBatch(this->Wrapper, &loader, filePaths, first, count))
+        {
+        consumer->consume(analyze(this->Wrapper, item));
+        }
+      }
+    return;
+    }
+
+  // The calling thread loads the headers and hands the analyses over, so
+  // that the analysers and it stay within the thread budget. It loads a
+  // batch whenever half of the window is free, and otherwise waits for the
+  // next analysis in input order.
+  int windowSize = this->windowSize();
+  int batchSize = qMax(1, windowSize / 2);
+  PipelineState state(this->Wrapper, this->AnalyserCount, windowSize);
+  QList<AnalyserThread*> analysers;
+  for (int i = 0; i < this->AnalyserCount; ++i)
+    {
+    analysers << new AnalyserThread(&state);
+    analysers.last()->start();
+    }
+
+  // Threads of the budget left by the analysers. Batches still have their
+  // reads in flight together with io_uring.
+  ctkPythonQtWrapperFileLoader loader;
+  loader.setThreadCount(this->Wrapper->maximumThreadCount() - this->AnalyserCount);
+  int loadedCount = 0;
+  int consumedCount = 0;
+  while (consumedCount < filePaths.count())
+    {
+    int count = qMin(batchSize, filePaths.count() - loadedCount);
+    if (count > 0 && loadedCount + count - consumedCount <= windowSize)
+      {
+      foreach(const PipelineItem& item,
+              loadBatch(this->Wrapper, &loader, filePaths, loadedCount, count))
+        {
+        state.LoadedItems.push(item);
+        }
+      loadedCount += count;
+      if (loadedCount == filePaths.count())
+        {
+        // One end-of-stream marker per analyser
+        for (int i = 0; i < this->AnalyserCount; ++i)
+          {
+          state.LoadedItems.push(PipelineItem());
+          }
+        }
+      continue;
+      }
+
+    ctkPythonQtWrapperAnalysis analysis;
+      {
+      QMutexLocker locker(&state.ResultsMutex);
+      while (!state.Results.contains(consumedCount))
+        {
+        state.ResultAvailable.wait(&state.ResultsMutex);
+        }
+      analysis = state.Results.take(consumedCount);
+      }
+    consumer->consume(analysis);
+    ++consumedCount;
+    }
+
+  foreach(AnalyserThread* analyser, analysers)
+    {
+    analyser->wait();
+    }
+  qDeleteAll(analysers);
+}
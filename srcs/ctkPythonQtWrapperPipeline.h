@@ -0,0 +1,77 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperPipeline_h
+#define __ctkPythonQtWrapperPipeline_h
+
+// Qt includes
+#include <QStringList>
+
+class ctkPythonQtWrapper;
+class ctkPythonQtWrapperAnalysis;
+
+/**
+ * Streaming analysis of a list of headers.
+ *
+ * The thread calling run() loads the headers by batches, a pool of analyser
+ * threads runs ctkPythonQtWrapper::analyze() on them, and the calling
+ * thread hands the analyses over to a Consumer in input order. No other
+ * thread is started: the pipeline uses analyserCount() + 1 threads, plus
+ * the threads of ctkPythonQtWrapperFileLoader within what remains of
+ * ctkPythonQtWrapper::maximumThreadCount().
+ *
+ * At most windowSize() headers are in flight between loading and
+ * consumption: the calling thread consumes analyses before loading more.
+ * The memory used by header contents therefore does not depend on the
+ * number of inputs.
+ *
+ * With an analyser count of 0, everything runs in the calling thread.
+ */
+class ctkPythonQtWrapperPipeline
+{
+public:
+  /// Receive the analyses, in input order, in the thread calling run().
+  class Consumer
+  {
+  public:
+    virtual ~Consumer(){}
+    virtual void consume(const ctkPythonQtWrapperAnalysis& analysis) = 0;
+  };
+
+  ctkPythonQtWrapperPipeline(const ctkPythonQtWrapper* wrapper);
+
+  int analyserCount()const;
+  void setAnalyserCount(int count);
+
+  /// Defaults to four headers per analyser, and at least 16. Headers are
+  /// read by batches of half the window (of the whole window when
+  /// everything runs in the calling thread), see ctkPythonQtWrapperFileLoader.
+  int windowSize()const;
+  void setWindowSize(int size);
+
+  void run(const QStringList& filePaths, Consumer* consumer);
+
+private:
+  const ctkPythonQtWrapper* Wrapper;
+  int AnalyserCount;
+  int WindowSize;
+};
+
+#endif
@@ -0,0 +1,374 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperRegistry.h"
+
+// STD includes
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <errno.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperRegistry::ctkPythonQtWrapperRegistry(const QString& fileName)
+{
+  this->FileName = fileName;
+  this->Modified = false;
+#ifdef _WIN32
+  this->LockHandle = INVALID_HANDLE_VALUE;
+#else
+  this->LockFd = -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperRegistry::~ctkPythonQtWrapperRegistry()
+{
+  this->unlock();
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperRegistry::fileName()const
+{
+  return this->FileName;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperRegistry::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperRegistry::lock()
+{
+  QString lockFileName = this->FileName + ".lock";
+#ifdef _WIN32
+  this->LockHandle = CreateFileW(reinterpret_cast<const wchar_t*>(lockFileName.utf16()),
+                                 GENERIC_READ | GENERIC_WRITE,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                 NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (this->LockHandle == INVALID_HANDLE_VALUE)
+    {
+    this->ErrorString = QString("%1 - Failed to open lock file").arg(lockFileName);
+    return false;
+    }
+  OVERLAPPED overlapped;
+  memset(&overlapped, 0, sizeof(overlapped));
+  if (!LockFileEx(this->LockHandle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped))
+    {
+    this->ErrorString = QString("%1 - Failed to lock").arg(lockFileName);
+    CloseHandle(this->LockHandle);
+    this->LockHandle = INVALID_HANDLE_VALUE;
+    return false;
+    }
+#else
+  this->LockFd = ::open(QFile::encodeName(lockFileName).constData(), O_RDWR | O_CREAT, 0666);
+  if (this->LockFd < 0)
+    {
+    this->ErrorString = QString("%1 - Failed to open lock file: %2").arg(
+          lockFileName, QString::fromLocal8Bit(strerror(errno)));
+    return false;
+    }
+  // fcntl() locks work over NFS, unlike flock() on some systems
+  struct flock lock;
+  memset(&lock, 0, sizeof(lock));
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  int result;
+  do
+    {
+    result = fcntl(this->LockFd, F_SETLKW, &lock);
+    }
+  while (result < 0 && errno == EINTR);
+  if (result < 0)
+    {
+    this->ErrorString = QString("%1 - Failed to lock: %2").arg(
+          lockFileName, QString::fromLocal8Bit(strerror(errno)));
+    ::close(this->LockFd);
+    this->LockFd = -1;
+    return false;
+    }
+#endif
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperRegistry::unlock()
+{
+  // Closing the file releases the lock
+#ifdef _WIN32
+  if (this->LockHandle != INVALID_HANDLE_VALUE)
+    {
+    CloseHandle(this->LockHandle);
+    this->LockHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+  if (this->LockFd >= 0)
+    {
+    ::close(this->LockFd);
+    this->LockFd = -1;
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperRegistry::open()
+{
+  this->Owners.clear();
+  this->Users.clear();
+  this->Modified = false;
+  if (!this->lock())
+    {
+    return false;
+    }
+
+  QFile file(this->FileName);
+  if (!file.exists())
+    {
+    return true;
+    }
+  if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+    this->ErrorString = QString("%1 - %2").arg(this->FileName, file.errorString());
+    this->unlock();
+    return false;
+    }
+  QTextStream stream(&file);
+  int lineNumber = 0;
+  while (!stream.atEnd())
+    {
+    QString line = stream.readLine().trimmed();
+    ++lineNumber;
+    if (line.isEmpty() || line.startsWith('#'))
+      {
+      continue;
+      }
+    QStringList fields = line.split(' ', QString::SkipEmptyParts);
+    if (fields.count() < 3 || fields.count() % 2 == 0)
+      {
+      this->ErrorString = QString("%1:%2 - Expected '<class> <wrapping-namespace> "
+                                  "<target-name> [<user-wrapping-namespace> <user-target-name> ...]'")
+          .arg(this->FileName).arg(lineNumber);
+      this->unlock();
+      return false;
+      }
+    this->Owners.insert(fields.at(0), Owner(fields.at(1), fields.at(2)));
+    for (int i = 3; i + 1 < fields.count(); i += 2)
+      {
+      this->Users[fields.at(0)] << Owner(fields.at(i), fields.at(i + 1));
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperRegistry::close()
+{
+  if (this->Modified)
+    {
+    // Write a temporary file and rename it over the registry, so that a
+    // generator killed while writing never leaves it truncated
+    QString temporaryFileName = this->FileName + ".tmp";
+    QFile file(temporaryFileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+      {
+      this->ErrorString = QString("%1 - %2").arg(temporaryFileName, file.errorString());
+      this->unlock();
+      return false;
+      }
+    QTextStream stream(&file);
+    stream << "# <class> <wrapping-namespace> <target-name> "
+              "[<user-wrapping-namespace> <user-target-name> ...]\n";
+    QMapIterator<QString, Owner> it(this->Owners);
+    while (it.hasNext())
+      {
+      it.next();
+      stream << it.key() << ' ' << it.value().first << ' ' << it.value().second;
+      foreach(const Owner& user, this->Users.value(it.key()))
+        {
+        stream << ' ' << user.first << ' ' << user.second;
+        }
+      stream << '\n';
+      }
+    stream.flush();
+    file.close();
+    if (file.error() != QFile::NoError)
+      {
+      this->ErrorString = QString("%1 - %2").arg(temporaryFileName, file.errorString());
+      QFile::remove(temporaryFileName);
+      this->unlock();
+      return false;
+      }
+#ifdef _WIN32
+    bool renamed = MoveFileExW(reinterpret_cast<const wchar_t*>(temporaryFileName.utf16()),
+                               reinterpret_cast<const wchar_t*>(this->FileName.utf16()),
+                               MOVEFILE_REPLACE_EXISTING) != 0;
+    QString renameError = "Failed to replace the registry";
+#else
+    bool renamed = ::rename(QFile::encodeName(temporaryFileName).constData(),
+                            QFile::encodeName(this->FileName).constData()) == 0;
+    QString renameError = QString::fromLocal8Bit(strerror(errno));
+#endif
+    if (!renamed)
+      {
+      this->ErrorString = QString("%1 - %2").arg(this->FileName, renameError);
+      QFile::remove(temporaryFileName);
+      this->unlock();
+      return false;
+      }
+    this->Modified = false;
+    }
+  this->unlock();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperRegistry::owner(const QString& className, QString& wrappingNamespace,
+                                       QString& targetName)const
+{
+  QMap<QString, Owner>::const_iterator it = this->Owners.constFind(className);
+  if (it == this->Owners.constEnd())
+    {
+    return false;
+    }
+  wrappingNamespace = it.value().first;
+  targetName = it.value().second;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperRegistry::setOwner(const QString& className,
+                                          const QString& wrappingNamespace,
+                                          const QString& targetName)
+{
+  Owner owner(wrappingNamespace, targetName);
+  QMap<QString, Owner>::iterator it = this->Owners.find(className);
+  if (it != this->Owners.end() && it.value() == owner)
+    {
+    return;
+    }
+  this->Owners.insert(className, owner);
+  // A user taking over a released class
+  this->removeUser(className, wrappingNamespace, targetName);
+  this->Modified = true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperRegistry::removeOwner(const QString& className)
+{
+  if (this->Owners.remove(className))
+    {
+    this->Users.remove(className);
+    this->Modified = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperRegistry::addUser(const QString& className,
+                                         const QString& wrappingNamespace,
+                                         const QString& targetName)
+{
+  Owner user(wrappingNamespace, targetName);
+  QList<Owner>& users = this->Users[className];
+  if (!users.contains(user))
+    {
+    users << user;
+    this->Modified = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperRegistry::removeUser(const QString& className,
+                                            const QString& wrappingNamespace,
+                                            const QString& targetName)
+{
+  QMap<QString, QList<Owner> >::iterator it = this->Users.find(className);
+  if (it == this->Users.end())
+    {
+    return;
+    }
+  if (it.value().removeAll(Owner(wrappingNamespace, targetName)) > 0)
+    {
+    this->Modified = true;
+    }
+  if (it.value().isEmpty())
+    {
+    this->Users.erase(it);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperRegistry::users(const QString& className)const
+{
+  QStringList targets;
+  foreach(const Owner& user, this->Users.value(className))
+    {
+    targets << user.first + ' ' + user.second;
+    }
+  return targets;
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperRegistry::classes(const QString& wrappingNamespace,
+                                                const QString& targetName)const
+{
+  Owner owner(wrappingNamespace, targetName);
+  QStringList classNames;
+  QMapIterator<QString, Owner> it(this->Owners);
+  while (it.hasNext())
+    {
+    it.next();
+    if (it.value() == owner)
+      {
+      classNames << it.key();
+      }
+    }
+  return classNames;
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkPythonQtWrapperRegistry::usedClasses(const QString& wrappingNamespace,
+                                                    const QString& targetName)const
+{
+  Owner user(wrappingNamespace, targetName);
+  QStringList classNames;
+  QMapIterator<QString, QList<Owner> > it(this->Users);
+  while (it.hasNext())
+    {
+    it.next();
+    if (it.value().contains(user))
+      {
+      classNames << it.key();
+      }
+    }
+  return classNames;
+}
@@ -0,0 +1,112 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperRegistry_h
+#define __ctkPythonQtWrapperRegistry_h
+
+// Qt includes
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+/**
+ * File recording which target wraps each class, shared by the generators
+ * of several targets so that a header passed to more than one target is
+ * only wrapped and registered once.
+ *
+ * The file lists one class per line, with its owner followed by the other
+ * targets listing it, its users:
+ *
+ * \code
+ * # <class> <wrapping-namespace> <target-name> [<user-wrapping-namespace> <user-target-name> ...]
+ * ctkFooWidget org.commontk.foo ctkFoo org.commontk.bar ctkBar
+ * \endcode
+ *
+ * A user only references the class, so it is not wrapped anymore when the
+ * owner releases it, until the users are generated again. The build must
+ * therefore make the generation of every user depend on the generation of
+ * the owner: the owner is then generated first, and the users are generated
+ * again when the owner changes. The owner reports the classes it releases
+ * while they still have users.
+ *
+ * open() takes an exclusive lock on "<file>.lock", waiting for the other
+ * generators to release it, and close() writes "<file>.tmp" and renames it
+ * over the registry before releasing it. Every read-modify-write of the
+ * registry therefore happens under the lock, generators can update it
+ * concurrently, and an interrupted write leaves the previous registry.
+ */
+class ctkPythonQtWrapperRegistry
+{
+public:
+  ctkPythonQtWrapperRegistry(const QString& fileName);
+  /// Release the lock without writing the file if close() was not called.
+  ~ctkPythonQtWrapperRegistry();
+
+  QString fileName()const;
+  QString errorString()const;
+
+  /// Lock and read the registry. A missing file is an empty registry.
+  bool open();
+  /// Write the registry if it was modified, and release the lock.
+  bool close();
+
+  /// Set \a wrappingNamespace and \a targetName to the owner of
+  /// \a className, and return false if it has none.
+  bool owner(const QString& className, QString& wrappingNamespace, QString& targetName)const;
+  void setOwner(const QString& className, const QString& wrappingNamespace,
+                const QString& targetName);
+
+  /// Remove the owner of \a className, and its users.
+  void removeOwner(const QString& className);
+
+  /// Record that the target lists \a className, owned by another target.
+  void addUser(const QString& className, const QString& wrappingNamespace,
+               const QString& targetName);
+  void removeUser(const QString& className, const QString& wrappingNamespace,
+                  const QString& targetName);
+  /// Users of \a className, as "<wrapping-namespace> <target-name>".
+  QStringList users(const QString& className)const;
+
+  /// Classes owned by the target.
+  QStringList classes(const QString& wrappingNamespace, const QString& targetName)const;
+  /// Classes the target uses without owning them.
+  QStringList usedClasses(const QString& wrappingNamespace, const QString& targetName)const;
+
+private:
+  bool lock();
+  void unlock();
+
+  typedef QPair<QString, QString> Owner;
+
+  QString              FileName;
+  QString              ErrorString;
+  QMap<QString, Owner> Owners;
+  QMap<QString, QList<Owner> > Users;
+  bool                 Modified;
+#ifdef _WIN32
+  void*                LockHandle;
+#else
+  int                  LockFd;
+#endif
+};
+
+#endif
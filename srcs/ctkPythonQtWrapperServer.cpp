@@ -0,0 +1,567 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperServer.h"
+
+// STD includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+# include <errno.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <signal.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+
+#ifndef _WIN32
+namespace
+{
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+// Incremented whenever the greeting, the request or the reply changes
+const quint32 ProtocolVersion = 2;
+// Upper bound of the arguments of a request
+const quint32 MaximumRequestSize = 16 * 1024 * 1024;
+// An idle server greets a client as soon as it connects. Without greeting
+// by then, the server is handling another request and the client runs its
+// own in-process rather than waiting in the queue.
+const int GreetingTimeout = 100;
+// A client sends its request as soon as it is greeted. One which stalls
+// longer than this on a read is dropped, so that it can't hold the server.
+const int RequestTimeout = 5000;
+
+//-----------------------------------------------------------------------------
+bool sendAll(int fd, const char* data, size_t size)
+{
+  while (size > 0)
+    {
+    ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      {
+      continue;
+      }
+    if (n <= 0)
+      {
+      return false;
+      }
+    data += n;
+    size -= static_cast<size_t>(n);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Wait up to \a timeout ms for data to read on \a fd.
+bool waitForReadyRead(int fd, int timeout)
+{
+  struct pollfd descriptor;
+  descriptor.fd = fd;
+  descriptor.events = POLLIN;
+  descriptor.revents = 0;
+  int result = 0;
+  do
+    {
+    result = ::poll(&descriptor, 1, timeout);
+    }
+  while (result < 0 && errno == EINTR);
+  return result > 0;
+}
+
+//-----------------------------------------------------------------------------
+// Without \a timeout, wait as long as it takes for the \a size bytes.
+// Otherwise, fail when no data comes within \a timeout ms for a read.
+bool receiveAll(int fd, char* data, size_t size, int timeout = -1)
+{
+  while (size > 0)
+    {
+    if (timeout >= 0 && !waitForReadyRead(fd, timeout))
+      {
+      return false;
+      }
+    ssize_t n = ::recv(fd, data, size, 0);
+    if (n < 0 && errno == EINTR)
+      {
+      continue;
+      }
+    if (n <= 0)
+      {
+      return false;
+      }
+    data += n;
+    size -= static_cast<size_t>(n);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Effective user ID of the process connected on \a fd.
+bool peerUserId(int fd, uid_t& uid)
+{
+#if defined(__linux__)
+  struct ucred credentials;
+  socklen_t length = sizeof(credentials);
+  if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0)
+    {
+    return false;
+    }
+  uid = credentials.uid;
+  return true;
+#else
+  gid_t gid;
+  return ::getpeereid(fd, &uid, &gid) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// The requests run with the descriptors and the permissions of the server:
+// both ends must belong to the same user.
+bool isSameUser(int fd)
+{
+  uid_t uid;
+  return peerUserId(fd, uid) && uid == ::geteuid();
+}
+
+//-----------------------------------------------------------------------------
+bool socketAddress(const QString& socketPath, struct sockaddr_un& address,
+                   QString& errorString)
+{
+  QByteArray path = QFile::encodeName(socketPath);
+  std::memset(&address, 0, sizeof(address));
+  if (path.isEmpty() || static_cast<size_t>(path.size()) >= sizeof(address.sun_path))
+    {
+    errorString = QString("Invalid socket path [%1]").arg(socketPath);
+    return false;
+    }
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.constData(), path.size());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int connectSocket(const struct sockaddr_un& address)
+{
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    {
+    return -1;
+    }
+  int result = 0;
+  do
+    {
+    result = ::connect(fd, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address));
+    }
+  while (result < 0 && errno == EINTR);
+  if (result < 0)
+    {
+    ::close(fd);
+    return -1;
+    }
+  return fd;
+}
+
+//-----------------------------------------------------------------------------
+void flushStandardStreams()
+{
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+}
+}
+#endif
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperServer::ctkPythonQtWrapperServer()
+{
+  this->ListenFd = -1;
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperServer::~ctkPythonQtWrapperServer()
+{
+  this->close();
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperServer::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperServer::listen(const QString& socketPath)
+{
+  this->close();
+
+#ifdef _WIN32
+  Q_UNUSED(socketPath);
+  this->ErrorString = "Server mode is not supported on this platform";
+  return false;
+#else
+  struct sockaddr_un address;
+  if (!socketAddress(socketPath, address, this->ErrorString))
+    {
+    return false;
+    }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    {
+    this->ErrorString = QString("Failed to create socket: %1").arg(std::strerror(errno));
+    return false;
+    }
+  ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  // Only the user running the server may connect: the socket file is
+  // created with mode 0600, from the start
+  mode_t previousMask = ::umask(0177);
+  const struct sockaddr* boundAddress = reinterpret_cast<const struct sockaddr*>(&address);
+  int result = ::bind(fd, boundAddress, sizeof(address));
+  if (result < 0 && errno == EADDRINUSE)
+    {
+    // Nobody accepting connections means the file was left by a server
+    // which didn't exit cleanly.
+    int probeFd = connectSocket(address);
+    if (probeFd >= 0)
+      {
+      ::close(probeFd);
+      ::close(fd);
+      this->ErrorString = QString("Another server is listening on %1").arg(socketPath);
+      return false;
+      }
+    ::unlink(address.sun_path);
+    result = ::bind(fd, boundAddress, sizeof(address));
+    }
+  ::umask(previousMask);
+  if (result < 0 || ::listen(fd, SOMAXCONN) < 0)
+    {
+    this->ErrorString = QString("Failed to listen on %1: %2").arg(socketPath, std::strerror(errno));
+    ::close(fd);
+    return false;
+    }
+
+  // Clients going away while their request writes to their output must not
+  // terminate the server
+  ::signal(SIGPIPE, SIG_IGN);
+
+  this->ListenFd = fd;
+  this->SocketPath = socketPath;
+  return true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperServer::close()
+{
+#ifndef _WIN32
+  if (this->ListenFd >= 0)
+    {
+    ::close(this->ListenFd);
+    ::unlink(QFile::encodeName(this->SocketPath).constData());
+    }
+#endif
+  this->ListenFd = -1;
+  this->SocketPath.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperServer::exec(Handler* handler)
+{
+#ifdef _WIN32
+  Q_UNUSED(handler);
+  this->ErrorString = "Server mode is not supported on this platform";
+  return false;
+#else
+  if (this->ListenFd < 0)
+    {
+    this->ErrorString = "Server is not listening";
+    return false;
+    }
+  for (;;)
+    {
+    int fd = ::accept(this->ListenFd, 0, 0);
+    if (fd < 0)
+      {
+      if (errno == EINTR || errno == ECONNABORTED)
+        {
+        continue;
+        }
+      this->ErrorString = QString("Failed to accept connection: %1").arg(std::strerror(errno));
+      return false;
+      }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (!isSameUser(fd))
+      {
+      std::cerr << "warning: Rejected a connection from another user" << std::endl;
+      ::close(fd);
+      continue;
+      }
+    uchar greeting[4];
+    qToBigEndian<quint32>(ProtocolVersion, greeting);
+    if (sendAll(fd, reinterpret_cast<const char*>(greeting), sizeof(greeting)))
+      {
+      this->handleConnection(fd, handler);
+      }
+    ::close(fd);
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperServer::handleConnection(int fd, Handler* handler)
+{
+#ifdef _WIN32
+  Q_UNUSED(fd);
+  Q_UNUSED(handler);
+  return false;
+#else
+  // The standard output and error of the client come along with the size
+  // of the request
+  uchar header[4];
+  struct iovec vector;
+  vector.iov_base = header;
+  vector.iov_len = sizeof(header);
+  union
+    {
+    struct cmsghdr Align;
+    char Buffer[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control.Buffer;
+  message.msg_controllen = sizeof(control.Buffer);
+
+  if (!waitForReadyRead(fd, RequestTimeout))
+    {
+    return false;
+    }
+  ssize_t received = 0;
+  do
+    {
+    received = ::recvmsg(fd, &message, 0);
+    }
+  while (received < 0 && errno == EINTR);
+  if (received <= 0)
+    {
+    return false;
+    }
+
+  int clientFds[2] = { -1, -1 };
+  int clientFdCount = 0;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg))
+    {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+      {
+      continue;
+      }
+    const int* fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    int count = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+    for (int i = 0; i < count; ++i)
+      {
+      if (clientFdCount < 2)
+        {
+        clientFds[clientFdCount++] = fds[i];
+        }
+      else
+        {
+        ::close(fds[i]);
+        }
+      }
+    }
+
+  QByteArray payload;
+  bool valid = clientFdCount == 2
+      && (message.msg_flags & MSG_CTRUNC) == 0
+      && receiveAll(fd, reinterpret_cast<char*>(header) + received,
+                    sizeof(header) - static_cast<size_t>(received), RequestTimeout);
+  if (valid)
+    {
+    quint32 size = qFromBigEndian<quint32>(header);
+    valid = size <= MaximumRequestSize;
+    if (valid)
+      {
+      payload.resize(static_cast<int>(size));
+      valid = receiveAll(fd, payload.data(), size, RequestTimeout);
+      }
+    }
+
+  quint32 version = 0;
+  QString workingDirectory;
+  QStringList arguments;
+  if (valid)
+    {
+    QDataStream stream(payload);
+    stream >> version >> workingDirectory >> arguments;
+    valid = stream.status() == QDataStream::Ok && version == ProtocolVersion;
+    }
+  if (!valid)
+    {
+    for (int i = 0; i < clientFdCount; ++i)
+      {
+      ::close(clientFds[i]);
+      }
+    return false;
+    }
+
+  // Run the request as the client process would
+  QString serverDirectory = QDir::currentPath();
+  flushStandardStreams();
+  int savedOutput = ::dup(STDOUT_FILENO);
+  int savedError = ::dup(STDERR_FILENO);
+  ::dup2(clientFds[0], STDOUT_FILENO);
+  ::dup2(clientFds[1], STDERR_FILENO);
+  ::close(clientFds[0]);
+  ::close(clientFds[1]);
+
+  int exitCode = EXIT_FAILURE;
+  if (QDir::setCurrent(workingDirectory))
+    {
+    exitCode = handler->handle(arguments);
+    }
+  else
+    {
+    std::cerr << "error: Failed to change to directory ["
+        << qPrintable(workingDirectory) << "]" << std::endl;
+    }
+
+  flushStandardStreams();
+  ::dup2(savedOutput, STDOUT_FILENO);
+  ::dup2(savedError, STDERR_FILENO);
+  ::close(savedOutput);
+  ::close(savedError);
+  QDir::setCurrent(serverDirectory);
+
+  uchar reply[4];
+  qToBigEndian<qint32>(exitCode, reply);
+  return sendAll(fd, reinterpret_cast<const char*>(reply), sizeof(reply));
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperServer::forward(const QString& socketPath, const QStringList& arguments,
+                                      QString& errorString)
+{
+#ifdef _WIN32
+  Q_UNUSED(socketPath);
+  Q_UNUSED(arguments);
+  errorString = "Server mode is not supported on this platform";
+  return -1;
+#else
+  struct sockaddr_un address;
+  if (!socketAddress(socketPath, address, errorString))
+    {
+    return -1;
+    }
+  int fd = connectSocket(address);
+  if (fd < 0)
+    {
+    errorString = QString("No server listening on %1").arg(socketPath);
+    return -1;
+    }
+  // The standard output and error are only handed to a server of the same
+  // user, and only if it is available right away
+  if (!isSameUser(fd))
+    {
+    ::close(fd);
+    errorString = QString("The server listening on %1 belongs to another user").arg(socketPath);
+    return -1;
+    }
+  uchar greeting[4];
+  if (!waitForReadyRead(fd, GreetingTimeout)
+      || !receiveAll(fd, reinterpret_cast<char*>(greeting), sizeof(greeting)))
+    {
+    ::close(fd);
+    errorString = QString("The server listening on %1 is busy").arg(socketPath);
+    return -1;
+    }
+  if (qFromBigEndian<quint32>(greeting) != ProtocolVersion)
+    {
+    ::close(fd);
+    errorString = QString("The server listening on %1 runs another version").arg(socketPath);
+    return -1;
+    }
+
+  QByteArray payload;
+  QDataStream stream(&payload, QIODevice::WriteOnly);
+  stream << ProtocolVersion << QDir::currentPath() << arguments;
+
+  uchar header[4];
+  qToBigEndian<quint32>(static_cast<quint32>(payload.size()), header);
+  struct iovec vector;
+  vector.iov_base = header;
+  vector.iov_len = sizeof(header);
+  union
+    {
+    struct cmsghdr Align;
+    char Buffer[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+  std::memset(&control, 0, sizeof(control));
+  struct msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &vector;
+  message.msg_iovlen = 1;
+  message.msg_control = control.Buffer;
+  message.msg_controllen = sizeof(control.Buffer);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  ssize_t sent = 0;
+  do
+    {
+    sent = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+    }
+  while (sent < 0 && errno == EINTR);
+
+  uchar reply[4];
+  bool ok = sent > 0
+      && sendAll(fd, reinterpret_cast<const char*>(header) + sent,
+                 sizeof(header) - static_cast<size_t>(sent))
+      && sendAll(fd, payload.constData(), payload.size())
+      && receiveAll(fd, reinterpret_cast<char*>(reply), sizeof(reply));
+  ::close(fd);
+  if (!ok)
+    {
+    errorString = QString("Lost the connection to the server listening on %1").arg(socketPath);
+    return -1;
+    }
+  return qFromBigEndian<qint32>(reply);
+#endif
+}
@@ -0,0 +1,107 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperServer_h
+#define __ctkPythonQtWrapperServer_h
+
+// Qt includes
+#include <QString>
+#include <QStringList>
+
+/**
+ * Generator server listening on a UNIX domain socket, and its client.
+ *
+ * A server process keeps its state warm between invocations, e.g. the
+ * ctkPythonQtWrapperAnalysisCache of the headers, and runs the command
+ * lines forwarded by the clients as if they had been run by the client
+ * processes themselves:
+ *
+ * \code
+ * PythonQtWrapper --serve /tmp/PythonQtWrapper.socket &
+ * PythonQtWrapper --connect /tmp/PythonQtWrapper.socket -o out ctkFoo.h
+ * \endcode
+ *
+ * forward() sends the working directory and the arguments of the client,
+ * along with its standard output and error file descriptors (SCM_RIGHTS).
+ * The server runs the request with these descriptors in place of its own
+ * and with the working directory of the client, so that diagnostics go
+ * straight to the client's terminal or build log. The exit code of the
+ * request is sent back once it completes.
+ *
+ * Requests are handled one at a time, since the working directory and the
+ * standard descriptors are process-wide. The server greets every client it
+ * accepts, and a client not greeted within 100 ms gives up: forward()
+ * fails and the client runs the request in-process. Under a parallel
+ * build, the generators which find the server busy therefore run
+ * concurrently instead of queuing behind it. Conversely, the server drops
+ * a client which stalls for 5 s while sending its request.
+ *
+ * Only the user running the server can use it: the socket is created with
+ * mode 0600, and both ends reject a peer of another user (SO_PEERCRED or
+ * getpeereid()).
+ *
+ * On platforms without UNIX domain sockets, listen() and forward() fail.
+ */
+class ctkPythonQtWrapperServer
+{
+public:
+  /// Run the requests in the server process.
+  class Handler
+  {
+  public:
+    virtual ~Handler(){}
+    /// Return the exit code of the request. \a arguments starts with the
+    /// program name, as argv.
+    virtual int handle(const QStringList& arguments) = 0;
+  };
+
+  ctkPythonQtWrapperServer();
+  /// Stop listening and remove the socket file.
+  ~ctkPythonQtWrapperServer();
+
+  /// Create and listen on the socket \a socketPath. A socket file left by
+  /// a server which isn't running anymore is replaced, return false if
+  /// another server is listening on it.
+  bool listen(const QString& socketPath);
+
+  /// Handle the requests until an error occurs. Failures of a single
+  /// request, e.g. a client disconnecting, are not errors.
+  bool exec(Handler* handler);
+
+  void close();
+
+  QString errorString()const;
+
+  /// Run \a arguments on the server listening on \a socketPath and return
+  /// the exit code of the request, or -1 if it couldn't be run (e.g. no
+  /// server is listening, or it is busy), setting \a errorString.
+  static int forward(const QString& socketPath, const QStringList& arguments,
+                     QString& errorString);
+
+private:
+  /// Receive and run the request of the client connected on \a fd.
+  bool handleConnection(int fd, Handler* handler);
+
+  QString SocketPath;
+  int     ListenFd;
+  QString ErrorString;
+};
+
+#endif
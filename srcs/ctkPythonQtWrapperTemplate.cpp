@@ -0,0 +1,157 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapperTemplate.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+const char* VariableNames[] =
+{
+  "ClassName",
+  "ParentClassName",
+  "TargetName",
+  "WrappingNamespace",
+  "WrappingNamespaceUnderscore",
+  "Decorators"
+};
+
+//-----------------------------------------------------------------------------
+bool isNameCharacter(QChar c)
+{
+  return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperTemplate::ctkPythonQtWrapperTemplate()
+{
+  this->LiteralSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+const char* ctkPythonQtWrapperTemplate::variableName(Variable variable)
+{
+  if (variable < 0 || variable >= VariableCount)
+    {
+    return 0;
+    }
+  return VariableNames[variable];
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperTemplate::parse(const QString& text)
+{
+  this->Segments.clear();
+  this->LiteralSize = 0;
+  this->ErrorString.clear();
+
+  Segment literal;
+  int pos = 0;
+  while (pos < text.size())
+    {
+    int start = text.indexOf(QLatin1Char('@'), pos);
+    if (start < 0)
+      {
+      literal.Literal += text.mid(pos);
+      break;
+      }
+    literal.Literal += text.mid(pos, start - pos);
+
+    int end = start + 1;
+    while (end < text.size() && isNameCharacter(text.at(end)))
+      {
+      ++end;
+      }
+    if (end == start + 1 || end >= text.size() || text.at(end) != QLatin1Char('@'))
+      {
+      // Not a variable reference
+      literal.Literal += QLatin1Char('@');
+      pos = start + 1;
+      continue;
+      }
+
+    QString name = text.mid(start + 1, end - start - 1);
+    int variable = -1;
+    for (int i = 0; i < VariableCount; ++i)
+      {
+      if (name == QLatin1String(VariableNames[i]))
+        {
+        variable = i;
+        break;
+        }
+      }
+    if (variable < 0)
+      {
+      this->ErrorString = QString("Unknown template variable @%1@").arg(name);
+      this->Segments.clear();
+      return false;
+      }
+
+    if (!literal.Literal.isEmpty())
+      {
+      this->LiteralSize += literal.Literal.size();
+      this->Segments << literal;
+      literal = Segment();
+      }
+    Segment segment;
+    segment.Variable = variable;
+    this->Segments << segment;
+    pos = end + 1;
+    }
+
+  if (!literal.Literal.isEmpty())
+    {
+    this->LiteralSize += literal.Literal.size();
+    this->Segments << literal;
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkPythonQtWrapperTemplate::errorString()const
+{
+  return this->ErrorString;
+}
+
+//-----------------------------------------------------------------------------
+int ctkPythonQtWrapperTemplate::literalSize()const
+{
+  return this->LiteralSize;
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperTemplate::render(const QString* values, QString& output)const
+{
+  const Segment* segment = this->Segments.constData();
+  const Segment* end = segment + this->Segments.size();
+  for (; segment != end; ++segment)
+    {
+    if (segment->Variable < 0)
+      {
+      output += segment->Literal;
+      }
+    else
+      {
+      output += values[segment->Variable];
+      }
+    }
+}
@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperTemplate_h
+#define __ctkPythonQtWrapperTemplate_h
+
+// Qt includes
+#include <QString>
+#include <QVector>
+
+/**
+ * Code template parsed once and rendered many times.
+ *
+ * Variables are written @Name@, as in CMake's configure_file(). parse()
+ * splits the text into literal and variable segments, so that render()
+ * only appends the segments to the output, without rescanning the template
+ * or allocating intermediate strings.
+ *
+ * A '@' which is not part of a @Name@ sequence is kept as is. A @Name@
+ * sequence naming an unknown variable is an error.
+ */
+class ctkPythonQtWrapperTemplate
+{
+public:
+  enum Variable
+    {
+    ClassName = 0,
+    ParentClassName,
+    TargetName,
+    WrappingNamespace,
+    WrappingNamespaceUnderscore,
+    Decorators,
+    VariableCount
+    };
+
+  ctkPythonQtWrapperTemplate();
+
+  bool parse(const QString& text);
+  QString errorString()const;
+
+  /// Append the template to \a output, replacing each variable with
+  /// values[variable]. \a values must have VariableCount elements.
+  void render(const QString* values, QString& output)const;
+
+  /// Upper bound of the number of characters appended by render(), not
+  /// counting the variables.
+  int literalSize()const;
+
+  static const char* variableName(Variable variable);
+
+private:
+  class Segment
+  {
+  public:
+    Segment() : Variable(-1) {}
+    QString Literal;
+    int     Variable;
+  };
+
+  QVector<Segment> Segments;
+  int              LiteralSize;
+  QString          ErrorString;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFileInfo>
+#include <QStringList>
+
+// PythonQtWrapper includes
+#include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperWatcher.h"
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperWatcher::ctkPythonQtWrapperWatcher(ctkPythonQtWrapper* wrapper,
+                                                     QObject* parent)
+  : QObject(parent)
+{
+  this->Wrapper = wrapper;
+
+  // Editors often save in several steps, wait for them to settle down.
+  this->Timer.setSingleShot(true);
+  this->Timer.setInterval(20);
+
+  connect(&this->Watcher, SIGNAL(fileChanged(QString)),
+          this, SLOT(onFileChanged(QString)));
+  connect(&this->Watcher, SIGNAL(directoryChanged(QString)),
+          this, SLOT(onDirectoryChanged(QString)));
+  connect(&this->Timer, SIGNAL(timeout()), this, SLOT(update()));
+}
+
+//-----------------------------------------------------------------------------
+ctkPythonQtWrapperWatcher::~ctkPythonQtWrapperWatcher()
+{
+}
+
+//-----------------------------------------------------------------------------
+bool ctkPythonQtWrapperWatcher::start()
+{
+  QSet<QString> directories;
+  foreach(const QString& filePath, this->Wrapper->inputFiles())
+    {
+    if (QFileInfo(filePath).exists())
+      {
+      this->Watcher.addPath(filePath);
+      }
+    directories.insert(QFileInfo(filePath).absolutePath());
+    }
+  foreach(const QString& directory, directories)
+    {
+    this->Watcher.addPath(directory);
+    }
+  ctkPythonQtWrapperDebugMacro(this->Wrapper->logger(),
+      QString("watching [%1 files]").arg(this->Watcher.files().count()));
+  this->Wrapper->logger().flush();
+  return !this->Watcher.files().isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperWatcher::onFileChanged(const QString& path)
+{
+  this->PendingFiles.insert(path);
+  this->Timer.start();
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperWatcher::onDirectoryChanged(const QString& path)
+{
+  // A header replaced by a rename is no longer watched: look for inputs of
+  // this directory that came back.
+  QStringList watchedFiles = this->Watcher.files();
+  foreach(const QString& filePath, this->Wrapper->inputFiles())
+    {
+    if (!watchedFiles.contains(filePath)
+        && QFileInfo(filePath).absolutePath() == path
+        && QFileInfo(filePath).exists())
+      {
+      this->Watcher.addPath(filePath);
+      this->PendingFiles.insert(filePath);
+      this->Timer.start();
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkPythonQtWrapperWatcher::update()
+{
+  bool changed = false;
+  foreach(const QString& filePath, this->PendingFiles)
+    {
+    if (!QFileInfo(filePath).exists())
+      {
+      // Wait for the file to be recreated, see onDirectoryChanged()
+      continue;
+      }
+    if (!this->Watcher.files().contains(filePath))
+      {
+      this->Watcher.addPath(filePath);
+      }
+    if (!this->Wrapper->updateAnalysis(filePath))
+      {
+      continue;
+      }
+    ctkPythonQtWrapperDebugMacro(this->Wrapper->logger(), QString("changed [%1]").arg(filePath));
+    changed = true;
+    int index = this->Wrapper->inputFiles().indexOf(filePath);
+    const ctkPythonQtWrapperAnalysis& analysis = this->Wrapper->analyses().at(index);
+    if (!analysis.Valid)
+      {
+      ctkPythonQtWrapperErrorMacro(this->Wrapper->logger(), "error: " + analysis.ErrorString);
+      }
+    }
+  this->PendingFiles.clear();
+
+  if (changed && !this->Wrapper->generateOutputs())
+    {
+    ctkPythonQtWrapperErrorMacro(this->Wrapper->logger(), "error: " + this->Wrapper->lastError());
+    }
+  // The process keeps running, do not leave messages in the buffer
+  this->Wrapper->logger().flush();
+}
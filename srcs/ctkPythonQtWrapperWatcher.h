@@ -0,0 +1,68 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.commontk.org/LICENSE
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkPythonQtWrapperWatcher_h
+#define __ctkPythonQtWrapperWatcher_h
+
+// Qt includes
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+class ctkPythonQtWrapper;
+
+/**
+ * Keep the outputs of a ctkPythonQtWrapper up to date while its input
+ * headers are being edited.
+ *
+ * The input headers are watched with QFileSystemWatcher (inotify on Linux).
+ * Their directories are watched as well, so that headers saved by
+ * "write to a temporary file and rename" are picked up again. Changes
+ * notified within a few milliseconds of each other are coalesced. Only the
+ * changed headers are analysed again, and outputs are only rewritten if an
+ * analysis actually changed.
+ *
+ * The wrapper must have been analysed (see ctkPythonQtWrapper::generateOutputs())
+ * before start() is called, and must outlive the watcher.
+ */
+class ctkPythonQtWrapperWatcher : public QObject
+{
+  Q_OBJECT
+public:
+  ctkPythonQtWrapperWatcher(ctkPythonQtWrapper* wrapper, QObject* parent = 0);
+  virtual ~ctkPythonQtWrapperWatcher();
+
+  /// Start watching the input files of the wrapper.
+  bool start();
+
+protected slots:
+  void onFileChanged(const QString& path);
+  void onDirectoryChanged(const QString& path);
+  void update();
+
+private:
+  ctkPythonQtWrapper* Wrapper;
+  QFileSystemWatcher  Watcher;
+  QTimer              Timer;
+  QSet<QString>       PendingFiles;
+};
+
+#endif
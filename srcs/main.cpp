@@ -6,11 +6,18 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QThread>
 
 // PythonQtWrapper includes
 #include "ctkCommandLineParser.h"
+#include "ctkJobServerClient.h"
 #include "ctkPythonQtWrapper.h"
+#include "ctkPythonQtWrapperAnalysisCache.h"
+#include "ctkPythonQtWrapperMemoryStats.h"
+#include "ctkPythonQtWrapperModule.h"
+#include "ctkPythonQtWrapperServer.h"
 #include "ctkPythonQtWrapperVersion.h"
+#include "ctkPythonQtWrapperWatcher.h"
 
 // STD includes
 #include <iostream>
@@ -18,6 +25,41 @@
 
 namespace
 {
+//-----------------------------------------------------------------------------
+class Arguments
+{
+public:
+  ctkCommandLineArgument<bool>    Help;
+  ctkCommandLineArgument<bool>    Verbose;
+  ctkCommandLineArgument<QString> WrappingNamespace;
+  ctkCommandLineArgument<QString> TargetName;
+  ctkCommandLineArgument<bool>    CheckOnly;
+  ctkCommandLineArgument<QString> CheckReport;
+  ctkCommandLineArgument<QString> OutputDir;
+  ctkCommandLineArgument<QString> TemplateDir;
+  ctkCommandLineArgument<bool>    Watch;
+  ctkCommandLineArgument<int>     Jobs;
+  ctkCommandLineArgument<bool>    MemStats;
+  ctkCommandLineArgument<QString> ExportMacro;
+  ctkCommandLineArgument<QString> ExportHeader;
+  ctkCommandLineArgument<bool>    PolymorphicHandlers;
+  ctkCommandLineArgument<bool>    Decorators;
+  ctkCommandLineArgument<bool>    SplitWrappers;
+  ctkCommandLineArgument<QString> Registry;
+  ctkCommandLineArgument<bool>    Clang;
+  ctkCommandLineArgument<QString> ClangArgs;
+  ctkCommandLineArgument<QString> ClangPreamble;
+  ctkCommandLineArgument<QString> ModuleManifest;
+  ctkCommandLineArgument<bool>    Unity;
+  ctkCommandLineArgument<QString> InputDir;
+  ctkCommandLineArgument<QString> Include;
+  ctkCommandLineArgument<QString> Exclude;
+  ctkCommandLineArgument<QString> Serve;
+  ctkCommandLineArgument<QString> Connect;
+};
+
+int run(const QStringList& arguments, ctkPythonQtWrapperAnalysisCache* analysisCache);
+
 //-----------------------------------------------------------------------------
 void printHelp(const ctkCommandLineParser& parser)
 {
@@ -27,47 +69,281 @@ void printHelp(const ctkCommandLineParser& parser)
       << "Options\n"
       << qPrintable(parser.helpText()) << std::endl;
 }
+//-----------------------------------------------------------------------------
+// Same as QCoreApplication::arguments(), without creating the application
+// object. It is only needed by the event loop of --watch.
+QStringList commandLineArguments(int argc, char* argv[])
+{
+  QStringList arguments;
+  for (int i = 0; i < argc; ++i)
+    {
+    arguments << QString::fromLocal8Bit(argv[i]);
+    }
+  return arguments;
+}
+
+//-----------------------------------------------------------------------------
+// \a arguments without the occurrences of the option \a name and their value
+QStringList removeArgument(const QStringList& arguments, const QString& name)
+{
+  QStringList remaining;
+  for (int i = 0; i < arguments.count(); ++i)
+    {
+    if (i > 0 && arguments.at(i) == name)
+      {
+      ++i;
+      continue;
+      }
+    remaining << arguments.at(i);
+    }
+  return remaining;
+}
+
 //-----------------------------------------------------------------------------
 void printHelpUsage()
 {
   std::cerr << "Specify --help for usage." << std::endl;
 }
+
+//-----------------------------------------------------------------------------
+bool setUpClangBackend(const ctkCommandLineParser& parser, const Arguments& args,
+                       ctkPythonQtWrapper* wrapper)
+{
+  if (!parser.value(args.Clang))
+    {
+    return true;
+    }
+  if (!wrapper->setClangBackendEnabled(true))
+    {
+    ctkPythonQtWrapperErrorMacro(wrapper->logger(), "error: " + wrapper->lastError());
+    return false;
+    }
+  wrapper->clangAnalyzer().setArguments(
+        parser.value(args.ClangArgs).split(QRegExp("\\s+"), QString::SkipEmptyParts));
+  wrapper->clangAnalyzer().setPreambleFile(parser.value(args.ClangPreamble));
+  return true;
 }
 
 //-----------------------------------------------------------------------------
-int main(int argc, char * argv[])
+int generateModule(const ctkCommandLineParser& parser, const Arguments& args,
+                   const QString& outputDir, int jobs,
+                   ctkPythonQtWrapperAnalysisCache* analysisCache)
+{
+  QString moduleName = parser.value(args.TargetName);
+  if (moduleName.isEmpty())
+    {
+    std::cerr << "error: Target name hasn't been specified" << std::endl;
+    printHelpUsage();
+    return EXIT_FAILURE;
+    }
+
+  ctkPythonQtWrapperModule module;
+  module.setWrappingNamespace(parser.value(args.WrappingNamespace));
+  module.setName(moduleName);
+  module.setExportMacro(parser.value(args.ExportMacro));
+  module.setExportHeader(parser.value(args.ExportHeader));
+  module.setUnityBuild(parser.value(args.Unity));
+  module.setOutput(outputDir);
+  if (!module.readManifest(parser.value(args.ModuleManifest)))
+    {
+    std::cerr << "error: " << qPrintable(module.lastError()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString templateDir = parser.value(args.TemplateDir);
+  foreach(ctkPythonQtWrapper* target, module.targets())
+    {
+    target->setVerbose(parser.value(args.Verbose));
+    target->setMaximumThreadCount(jobs);
+    target->setPolymorphicHandlersEnabled(parser.value(args.PolymorphicHandlers));
+    target->setDecoratorsEnabled(parser.value(args.Decorators));
+    target->setSplitWrappersEnabled(parser.value(args.SplitWrappers));
+    target->setRegistryFile(parser.value(args.Registry));
+    target->setAnalysisCache(analysisCache);
+    if (!setUpClangBackend(parser, args, target))
+      {
+      return EXIT_FAILURE;
+      }
+    if (!templateDir.isEmpty() && !target->loadTemplates(templateDir))
+      {
+      ctkPythonQtWrapperErrorMacro(target->logger(), "error: " + target->lastError());
+      return EXIT_FAILURE;
+      }
+    }
+
+  module.validateInputFiles();
+
+  if (!module.generateOutputs())
+    {
+    std::cerr << "error: " << qPrintable(module.lastError()) << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// Run the requests forwarded by --connect, keeping the analyses of the
+// headers between them.
+class RequestHandler : public ctkPythonQtWrapperServer::Handler
+{
+public:
+  virtual int handle(const QStringList& arguments)
+  {
+    return run(arguments, &this->AnalysisCache);
+  }
+
+  ctkPythonQtWrapperAnalysisCache AnalysisCache;
+};
+
+//-----------------------------------------------------------------------------
+int serve(const QString& socketPath)
 {
-  QCoreApplication app(argc, argv);
+  ctkPythonQtWrapperServer server;
+  if (!server.listen(socketPath))
+    {
+    std::cerr << "error: " << qPrintable(server.errorString()) << std::endl;
+    return EXIT_FAILURE;
+    }
+  RequestHandler handler;
+  server.exec(&handler);
+  std::cerr << "error: " << qPrintable(server.errorString()) << std::endl;
+  return EXIT_FAILURE;
+}
 
+//-----------------------------------------------------------------------------
+// Requests of a server have an \a analysisCache, kept between requests.
+int run(const QStringList& arguments, ctkPythonQtWrapperAnalysisCache* analysisCache)
+{
   ctkCommandLineParser parser;
+  Arguments args;
   // Use Unix-style argument names
   parser.setArgumentPrefix("--", "-");
   // Add command line argument names
-  parser.addArgument("help", "h", QVariant::Bool, "Print usage information and exit.");
-  parser.addArgument("verbose", "v", QVariant::Bool, "Enable verbose output.");
-  parser.addArgument("wrapping-namespace", "wns", QVariant::String, "Wrapping namespace.", QVariant("org.commontk.foo"));
-  parser.addArgument("target-name", "p", QVariant::String, "Target name.");
-  parser.addArgument("check-only", "c", QVariant::Bool, "Return 1 (or 0) indicating if the file"
+  args.Help = parser.addArgument<bool>("help", "h", "Print usage information and exit.");
+  args.Verbose = parser.addArgument<bool>("verbose", "v", "Enable verbose output.");
+  args.WrappingNamespace = parser.addArgument<QString>("wrapping-namespace", "wns", "Wrapping namespace.", QString("org.commontk.foo"));
+  args.TargetName = parser.addArgument<QString>("target-name", "p", "Target name.");
+  args.CheckOnly = parser.addArgument<bool>("check-only", "c", "Return 1 (or 0) indicating if the file"
                      "could be successfully wrapped.");
-  parser.addArgument("output-dir", "o", QVariant::String, "Output directory");
+  args.CheckReport = parser.addArgument<QString>("check-report", "cr", "Check every header and write "
+                     "one tab separated line per header (path, accepted or rejected, parent "
+                     "class, reason) to the given file, or to the standard output if it is '-'.");
+  args.OutputDir = parser.addArgument<QString>("output-dir", "o", "Output directory");
+  args.TemplateDir = parser.addArgument<QString>("template-dir", "t", "Directory containing the "
+                     "ClassWrapperWithParent.in, ClassWrapperWithoutParent.in, "
+                     "RegisterClass.in and/or other templates overriding the built-in ones.");
+  args.Watch = parser.addArgument<bool>("watch", "w", "Keep running and regenerate the outputs "
+                     "whenever one of the headers changes.");
+  args.Jobs = parser.addArgument<int>("jobs", "j", "Maximum number of threads. When run "
+                     "under a GNU make jobserver, it is the upper bound of the job slots "
+                     "requested from it (0 means one per core).", 1);
+  args.MemStats = parser.addArgument<bool>("memstats", "", "Print the number of allocations, the "
+                     "allocated bytes and the peak resident set size after each phase "
+                     "(input, validate, generate, write) on the standard error. The "
+                     "allocations are only counted when built with "
+                     "PythonQtWrapper_USE_MEMORY_HOOKS.");
+  args.ExportMacro = parser.addArgument<QString>("export-macro", "", "Macro declaring the visibility "
+                     "of the generated init function, the other generated symbols are "
+                     "hidden. It is defined to export the function unless already defined.",
+                     QString("PythonQtWrapper_INIT_EXPORT"));
+  args.ExportHeader = parser.addArgument<QString>("export-header", "", "Header defining the export "
+                     "macro, included by the generated init file.");
+  args.PolymorphicHandlers = parser.addArgument<bool>("polymorphic-handlers", "", "Register a "
+                     "polymorphic handler for every wrapped class derived by another wrapped "
+                     "class, so that returned objects are downcasted with a table lookup.");
+  args.Decorators = parser.addArgument<bool>("decorators", "", "Add decorator slots calling the "
+                     "accessors of the Q_PROPERTY, the Q_INVOKABLE methods and the public slots "
+                     "directly, instead of through the meta-object.");
+  args.SplitWrappers = parser.addArgument<bool>("split-wrappers", "", "Only declare the wrapper "
+                     "classes in the generated header, forward declaring the wrapped classes, and "
+                     "define their slots in the generated init file.");
+  args.Registry = parser.addArgument<QString>("registry", "", "Registry file shared by the "
+                     "targets of a build. A class already wrapped by another target is only "
+                     "referenced, instead of being wrapped and registered twice. The "
+                     "generation of such a target must depend on the one of the owner.");
+  args.Clang = parser.addArgument<bool>("clang", "", "Find the constructors, the base class and "
+                     "the pure virtual methods of the classes by parsing the headers with "
+                     "libclang instead of matching their text. Slower, but exact.");
+  args.ClangArgs = parser.addArgument<QString>("clang-args", "", "Space separated compiler "
+                     "arguments passed to libclang, e.g. the -I options locating the Qt headers.");
+  args.ClangPreamble = parser.addArgument<QString>("clang-preamble", "", "Precompiled header of "
+                     "the Qt headers used by --clang, built if missing or out of date and reused "
+                     "by the next runs. A temporary one is built by default.");
+  args.ModuleManifest = parser.addArgument<QString>("module-manifest", "m", "Merge the targets listed in "
+                     "the given file, one '<wrapping-namespace> <target-name> <header> "
+                     "[<header> ...]' per line, into the module named by --target-name, "
+                     "with a single init function.");
+  args.Unity = parser.addArgument<bool>("unity", "", "With --module-manifest, generate the "
+                     "wrappers of all the targets into the module header and init file, "
+                     "instead of one header and init file per target.");
+  args.InputDir = parser.addArgument<QString>("input-dir", "", "Wrap the headers found below the "
+                     "given directory, in addition to the <path-to-cpp-header-file>. Private "
+                     "headers (*_p.h) are skipped.");
+  args.Include = parser.addArgument<QString>("include", "", "Comma separated wildcards selecting "
+                     "the headers of --input-dir. A wildcard containing a '/' matches the path "
+                     "relative to the directory, otherwise the file name.");
+  args.Exclude = parser.addArgument<QString>("exclude", "", "Comma separated wildcards of the "
+                     "headers and directories of --input-dir to skip, matched like --include.");
+  args.Serve = parser.addArgument<QString>("serve", "", "Listen on the given UNIX domain socket "
+                     "and run the command lines forwarded by --connect, keeping the analyses of "
+                     "the unchanged headers between them. The other options are ignored. The "
+                     "jobserver of a client isn't reachable from the server: a request uses "
+                     "as many threads as its --jobs, even if the build already runs as many "
+                     "jobs.");
+  args.Connect = parser.addArgument<QString>("connect", "", "Forward the command line to the "
+                     "server listening on the given socket, see --serve, and exit with its exit "
+                     "code. Run in-process if no server is listening or if it is busy. Defaults to the "
+                     "PYTHONQTWRAPPER_SERVER environment variable.",
+                     QString::fromLocal8Bit(qgetenv("PYTHONQTWRAPPER_SERVER")));
   
   // Parse the command line arguments
   bool ok = false;
-  QHash<QString, QVariant> parsedArgs = parser.parseArguments(QCoreApplication::arguments(), &ok);
+  parser.parseArguments(arguments, &ok);
   if (!ok)
     {
     std::cerr << "Error parsing arguments: " << qPrintable(parser.errorString()) << std::endl;
     printHelpUsage();
     return EXIT_FAILURE;
     }
+
+  QString serverSocket = parser.value(args.Connect);
+  if (analysisCache)
+    {
+    if (!parser.value(args.Serve).isEmpty() || parser.value(args.Watch))
+      {
+      std::cerr << "error: --serve and --watch can't be run by a server" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  else if (!serverSocket.isEmpty() && parser.value(args.Serve).isEmpty()
+           && !parser.value(args.Watch))
+    {
+    QString errorString;
+    int exitCode = ctkPythonQtWrapperServer::forward(
+          serverSocket, removeArgument(arguments, "--connect"), errorString);
+    if (exitCode >= 0)
+      {
+      return exitCode;
+      }
+    if (parser.value(args.Verbose))
+      {
+      std::cerr << "warning: " << qPrintable(errorString) << " - Running in-process" << std::endl;
+      }
+    }
   // Show help message
-  if (parsedArgs.contains("help"))
+  if (parser.value(args.Help))
     {
     printHelp(parser);
     return EXIT_SUCCESS;
     }
 
-  QString wrappingNamespace = parsedArgs.value("wrapping-namespace").toString();
+  QString serveSocket = parser.value(args.Serve);
+  if (!serveSocket.isEmpty())
+    {
+    return serve(serveSocket);
+    }
+
+  QString wrappingNamespace = parser.value(args.WrappingNamespace);
   if (wrappingNamespace.isEmpty())
     {
     std::cerr << "error: Wrapping namespace not specified" << std::endl;
@@ -81,7 +357,15 @@ int main(int argc, char * argv[])
     return EXIT_FAILURE;
     }
 
-  QString outputDir = parsedArgs.value("output-dir").toString();
+  QString checkReport = parser.value(args.CheckReport);
+  bool checkOnly = parser.value(args.CheckOnly) || !checkReport.isEmpty();
+
+  QString outputDir = parser.value(args.OutputDir);
+  if (checkOnly && outputDir.isEmpty())
+    {
+    // Nothing is written in the output directory when checking
+    outputDir = QDir::currentPath();
+    }
   if (outputDir.isEmpty())
     {
     std::cerr << "error: Output directory not specified" << std::endl;
@@ -96,48 +380,168 @@ int main(int argc, char * argv[])
     return EXIT_FAILURE;
     }
 
-  if (parser.unparsedArguments().count() == 0)
+  QString moduleManifest = parser.value(args.ModuleManifest);
+  QString inputDir = parser.value(args.InputDir);
+  if (!moduleManifest.isEmpty()
+      && (checkOnly || parser.value(args.Watch) || parser.unparsedArguments().count() > 0
+          || !inputDir.isEmpty()))
+    {
+    std::cerr << "error: --module-manifest can't be combined with --check-only, "
+                 "--check-report, --watch, --input-dir or <path-to-cpp-header-file>" << std::endl;
+    printHelpUsage();
+    return EXIT_FAILURE;
+    }
+
+  if (parser.value(args.Unity) && moduleManifest.isEmpty())
+    {
+    std::cerr << "error: --unity requires --module-manifest" << std::endl;
+    printHelpUsage();
+    return EXIT_FAILURE;
+    }
+
+  if (parser.unparsedArguments().count() == 0 && moduleManifest.isEmpty() && inputDir.isEmpty())
     {
     std::cerr << "error: <path-to-cpp-header-file> not specified" << std::endl;
     printHelpUsage();
     return EXIT_FAILURE;
     }
 
+  // Extra threads are only used when the jobserver hands out tokens, so that
+  // a parallel build does not get oversubscribed.
+  int jobs = parser.value(args.Jobs);
+  if (jobs <= 0)
+    {
+    jobs = qMax(1, QThread::idealThreadCount());
+    }
+  // The jobserver of a server request is the one of the client, which
+  // isn't reachable from the server process: the request runs --jobs
+  // threads, one unless the client asks for more.
+  ctkJobServerClient jobServer;
+  if (!analysisCache && jobServer.connectFromEnvironment())
+    {
+    jobs = 1 + jobServer.acquire(jobs - 1);
+    }
+
+  if (!moduleManifest.isEmpty())
+    {
+    return generateModule(parser, args, outputDir, jobs, analysisCache);
+    }
+
+  // The input phase covers the set up of the wrapper and its inputs
+  bool memStats = parser.value(args.MemStats);
+  ctkPythonQtWrapperMemoryStats::setEnabled(memStats);
+  ctkPythonQtWrapperMemoryStats memoryStats;
+
   ctkPythonQtWrapper wrapper;
-  wrapper.setVerbose(parsedArgs.contains("verbose"));
+  wrapper.setVerbose(parser.value(args.Verbose));
+  wrapper.setMaximumThreadCount(jobs);
   wrapper.setWrappingNamespace(wrappingNamespace);
+  wrapper.setExportMacro(parser.value(args.ExportMacro));
+  wrapper.setExportHeader(parser.value(args.ExportHeader));
+  wrapper.setPolymorphicHandlersEnabled(parser.value(args.PolymorphicHandlers));
+  wrapper.setDecoratorsEnabled(parser.value(args.Decorators));
+  wrapper.setSplitWrappersEnabled(parser.value(args.SplitWrappers));
+  wrapper.setRegistryFile(parser.value(args.Registry));
+  wrapper.setAnalysisCache(analysisCache);
+  if (!setUpClangBackend(parser, args, &wrapper))
+    {
+    return EXIT_FAILURE;
+    }
 
   if (!wrapper.setOutput(outputDir))
     {
-    std::cerr << "error: Failed to set output" << std::endl;
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: Failed to set output");
+    return EXIT_FAILURE;
+    }
+
+  QString templateDir = parser.value(args.TemplateDir);
+  if (!templateDir.isEmpty() && !wrapper.loadTemplates(templateDir))
+    {
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: " + wrapper.lastError());
     return EXIT_FAILURE;
     }
 
-  if (!wrapper.setInput(parser.unparsedArguments()))
+  if (parser.unparsedArguments().count() > 0 && !wrapper.setInput(parser.unparsedArguments()))
     {
-    std::cerr << "error: Failed to set input" << std::endl;
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: Failed to set input");
     return EXIT_FAILURE;
     }
+  if (!inputDir.isEmpty())
+    {
+    QStringList includePatterns = parser.value(args.Include).split(',', QString::SkipEmptyParts);
+    QStringList excludePatterns = parser.value(args.Exclude).split(',', QString::SkipEmptyParts);
+    if (!wrapper.addInputDirectory(inputDir, includePatterns, excludePatterns))
+      {
+      ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: " + wrapper.lastError());
+      return EXIT_FAILURE;
+      }
+    if (wrapper.inputFiles().isEmpty())
+      {
+      ctkPythonQtWrapperErrorMacro(wrapper.logger(), QString("error: No header found in [%1]").arg(inputDir));
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The report already tells which headers are rejected, and why
+  wrapper.setRejectionMessagesEnabled(checkReport.isEmpty());
+
+  if (memStats)
+    {
+    memoryStats.endPhase("input");
+    }
 
   int rejectedHeaders = wrapper.validateInputFiles();
 
-  if (parsedArgs.contains("check-only"))
+  if (memStats)
+    {
+    memoryStats.endPhase("validate");
+    if (checkOnly)
+      {
+      memoryStats.report(stderr);
+      }
+    }
+
+  if (!checkReport.isEmpty())
+    {
+    QFile reportFile;
+    bool opened = false;
+    if (checkReport == "-")
+      {
+      opened = reportFile.open(stdout, QIODevice::WriteOnly);
+      }
+    else
+      {
+      reportFile.setFileName(checkReport);
+      opened = reportFile.open(QIODevice::WriteOnly);
+      }
+    if (!opened || !wrapper.writeCheckReport(&reportFile))
+      {
+      ctkPythonQtWrapperErrorMacro(wrapper.logger(), QString("error: Failed to write check report [%1]")
+                                   .arg(checkReport));
+      return EXIT_FAILURE;
+      }
+    return EXIT_SUCCESS;
+    }
+
+  if (checkOnly)
     {
-    return rejectedHeaders;
+    // Exit codes are truncated to 8 bits
+    return qMin(rejectedHeaders, 255);
     }
 
-  if (rejectedHeaders == parser.unparsedArguments().count())
+  bool watch = parser.value(args.Watch);
+  if (rejectedHeaders == wrapper.inputFiles().count() && !watch)
     {
-    std::cerr << "error: All specified headers have been rejected" << std::endl;
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: All specified headers have been rejected");
     return EXIT_FAILURE;
     }
 
-  QString targetName = parsedArgs.value("target-name").toString();
-  if (parser.unparsedArguments().count() == 1)
+  QString targetName = parser.value(args.TargetName);
+  if (wrapper.inputFiles().count() == 1)
     {
     if (targetName.isEmpty())
       {
-      QFileInfo fileInfo(parser.unparsedArguments().value(0));
+      QFileInfo fileInfo(wrapper.inputFiles().value(0));
       targetName = fileInfo.baseName();
       }
     }
@@ -145,14 +549,58 @@ int main(int argc, char * argv[])
     {
     if (targetName.isEmpty())
       {
-      std::cerr << "error: Target name hasn't been specified" << std::endl;
+      ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: Target name hasn't been specified");
       printHelpUsage();
       return EXIT_FAILURE;
       }
     }
   wrapper.setTargetName(targetName);
 
-  wrapper.generateOutputs();
-  
+  if (!wrapper.registryFile().isEmpty() && !wrapper.updateRegistry())
+    {
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: " + wrapper.lastError());
+    return EXIT_FAILURE;
+    }
+
+  QMap<QString, QByteArray> outputs = wrapper.generateOutputBuffers();
+  if (memStats)
+    {
+    memoryStats.endPhase("generate");
+    }
+  bool written = wrapper.writeOutputBuffers(outputs);
+  outputs.clear();
+  if (memStats)
+    {
+    memoryStats.endPhase("write");
+    memoryStats.report(stderr);
+    }
+  if (!written)
+    {
+    ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: " + wrapper.lastError());
+    return EXIT_FAILURE;
+    }
+
+  if (watch)
+    {
+    QByteArray programName = arguments.value(0).toLocal8Bit();
+    int appArgc = 1;
+    char* appArgv[] = { programName.data(), 0 };
+    QCoreApplication app(appArgc, appArgv);
+    ctkPythonQtWrapperWatcher watcher(&wrapper);
+    if (!watcher.start())
+      {
+      ctkPythonQtWrapperErrorMacro(wrapper.logger(), "error: None of the specified headers can be watched");
+      return EXIT_FAILURE;
+      }
+    return app.exec();
+    }
+
   return EXIT_SUCCESS;
 }
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char * argv[])
+{
+  return run(commandLineArguments(argc, argv), 0);
+}